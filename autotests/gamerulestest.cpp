@@ -0,0 +1,450 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Plays random games on MineField and on a straightforward model of
+// the rules as they were implemented in MineFieldItem and CellItem
+// before the game logic moved into kminescore, and checks that every
+// cell agrees after every input. Covers the span fill, the opening
+// index, the FixedMineField kernels, chords, win/loss and the 3BV.
+// Also checks FixedMineField as a game against MineField
+
+// own
+#include "fixedminefield.h"
+#include "kminestest.h"
+#include "minefield.h"
+// Std
+#include <random>
+#include <vector>
+
+/**
+ * The rules cell by cell: recursive reveal of empty space, chords
+ * revealing neighbours one by one and scans over the whole field
+ */
+class ReferenceField
+{
+public:
+    explicit ReferenceField(const MineField& field)
+        : m_rows(field.rowCount()), m_cols(field.columnCount()), m_minesCount(field.minesCount()),
+          m_mines(field.cellCount()), m_digits(field.cellCount(), 0)
+    {
+        for(int idx=0; idx<field.cellCount(); ++idx)
+            m_mines[idx] = field.hasMine(idx);
+        for(int idx=0; idx<field.cellCount(); ++idx)
+        {
+            for (int neighbour : neighbours(idx)) {
+                m_digits[idx] += m_mines[neighbour];
+            }
+        }
+        reset();
+    }
+
+    void reset()
+    {
+        m_states.assign(m_mines.size(), KMinesState::Released);
+        m_exploded = -1;
+        m_numUnrevealed = static_cast<int>(m_mines.size());
+        m_gameOver = false;
+        m_won = false;
+    }
+
+    std::vector<int> neighbours(int idx) const
+    {
+        std::vector<int> result;
+        const int row = idx / m_cols;
+        const int col = idx % m_cols;
+        for(int r = row-1; r <= row+1; ++r)
+            for(int c = col-1; c <= col+1; ++c)
+                if((r != row || c != col) && r >= 0 && r < m_rows && c >= 0 && c < m_cols)
+                    result.push_back(r*m_cols + c);
+        return result;
+    }
+
+    void press(int idx)
+    {
+        if(m_states[idx] == KMinesState::Released)
+            m_states[idx] = KMinesState::Pressed;
+    }
+    void undoPress(int idx)
+    {
+        if(m_states[idx] == KMinesState::Pressed)
+            m_states[idx] = KMinesState::Released;
+    }
+    void mark(int idx, bool useQuestionMarks)
+    {
+        KMinesState::CellState& state = m_states[idx];
+        if(state == KMinesState::Released)
+            state = KMinesState::Flagged;
+        else if(state == KMinesState::Flagged)
+            state = useQuestionMarks ? KMinesState::Questioned : KMinesState::Released;
+        else if(state == KMinesState::Questioned)
+            state = KMinesState::Released;
+    }
+    void open(int idx)
+    {
+        if(m_gameOver || m_states[idx] != KMinesState::Pressed)
+            return;
+        release(idx);
+        onRevealed(idx);
+    }
+    void chord(int idx)
+    {
+        if(m_gameOver)
+            return;
+        const std::vector<int> around = neighbours(idx);
+        int numFlags = 0;
+        int numMines = 0;
+        for (int neighbour : around) {
+            numFlags += m_states[neighbour] == KMinesState::Flagged;
+            numMines += m_mines[neighbour];
+        }
+        if(!isRevealed(idx) || numFlags != numMines || numFlags == 0)
+        {
+            for (int neighbour : around) {
+                undoPress(neighbour);
+            }
+            return;
+        }
+        for (int neighbour : around) {
+            if(isRevealed(neighbour) || m_states[neighbour] == KMinesState::Flagged
+               || m_states[neighbour] == KMinesState::Questioned)
+                continue;
+            release(neighbour);
+            if(onRevealed(neighbour))
+                break;
+        }
+    }
+
+    bool isRevealed(int idx) const
+    {
+        return m_states[idx] == KMinesState::Revealed || m_states[idx] == KMinesState::Error;
+    }
+
+    /**
+     * @return number of openings and 3BV, by flooding each opening
+     */
+    std::pair<int, int> openingsAndThreeBV() const
+    {
+        std::vector<bool> visited(m_mines.size(), false);
+        int openings = 0;
+        int threeBV = 0;
+        for(int idx=0; idx<int(m_mines.size()); ++idx)
+        {
+            if(!isEmpty(idx) || visited[idx])
+                continue;
+            openings++;
+            std::vector<int> stack{ idx };
+            visited[idx] = true;
+            while(!stack.empty())
+            {
+                const int cell = stack.back();
+                stack.pop_back();
+                for (int neighbour : neighbours(cell)) {
+                    if(isEmpty(neighbour) && !visited[neighbour])
+                    {
+                        visited[neighbour] = true;
+                        stack.push_back(neighbour);
+                    }
+                }
+            }
+        }
+        for(int idx=0; idx<int(m_mines.size()); ++idx)
+        {
+            if(m_mines[idx] || isEmpty(idx))
+                continue;
+            bool bordersOpening = false;
+            for (int neighbour : neighbours(idx)) {
+                bordersOpening = bordersOpening || isEmpty(neighbour);
+            }
+            threeBV += !bordersOpening;
+        }
+        return { openings, threeBV + openings };
+    }
+
+    std::vector<KMinesState::CellState> m_states;
+    int m_exploded = -1;
+    int m_numUnrevealed = 0;
+    bool m_gameOver = false;
+    bool m_won = false;
+private:
+    bool isEmpty(int idx) const { return !m_mines[idx] && m_digits[idx] == 0; }
+    void reveal(int idx)
+    {
+        if(isRevealed(idx))
+            return;
+        if(m_states[idx] == KMinesState::Flagged && !m_mines[idx])
+            m_states[idx] = KMinesState::Error;
+        else
+            m_states[idx] = KMinesState::Revealed;
+    }
+    void release(int idx)
+    {
+        if(m_mines[idx])
+            m_exploded = idx;
+        reveal(idx);
+    }
+    void revealEmptySpace(int idx)
+    {
+        for (int neighbour : neighbours(idx)) {
+            const KMinesState::CellState state = m_states[neighbour];
+            if(isRevealed(neighbour) || state == KMinesState::Flagged || state == KMinesState::Questioned)
+                continue;
+            reveal(neighbour);
+            m_numUnrevealed--;
+            if(m_digits[neighbour] == 0)
+                revealEmptySpace(neighbour);
+        }
+    }
+    /**
+     * @return true if the game is over
+     */
+    bool onRevealed(int idx)
+    {
+        m_numUnrevealed--;
+        if(m_mines[idx])
+        {
+            for(int i=0; i<int(m_mines.size()); ++i)
+            {
+                const bool flagged = m_states[i] == KMinesState::Flagged;
+                if((flagged && !m_mines[i]) || (!flagged && m_mines[i] && !isRevealed(i)))
+                    reveal(i);
+            }
+            m_gameOver = true;
+            return true;
+        }
+        if(m_digits[idx] == 0)
+            revealEmptySpace(idx);
+        if(m_numUnrevealed != m_minesCount)
+            return false;
+        for(int i=0; i<int(m_mines.size()); ++i)
+        {
+            if(m_states[i] == KMinesState::Questioned)
+                mark(i, true);
+            if(!isRevealed(i) && m_states[i] != KMinesState::Flagged)
+                mark(i, true);
+        }
+        m_gameOver = true;
+        m_won = true;
+        return true;
+    }
+
+    int m_rows;
+    int m_cols;
+    int m_minesCount;
+    std::vector<bool> m_mines;
+    std::vector<int> m_digits;
+};
+
+struct Totals
+{
+    long games = 0;
+    long inputs = 0;
+    long cellChecks = 0;
+    long wins = 0;
+    long losses = 0;
+};
+
+/**
+ * @return true if field and reference agree on every cell
+ */
+static bool compare(const MineField& field, const ReferenceField& reference, Totals& totals)
+{
+    bool same = true;
+    for(int idx=0; idx<field.cellCount() && same; ++idx)
+    {
+        same = field.state(idx) == reference.m_states[idx]
+            && field.isExploded(idx) == (reference.m_exploded == idx);
+    }
+    totals.cellChecks += field.cellCount();
+    same = KMINES_CHECK(same) && KMINES_CHECK(field.isGameOver() == reference.m_gameOver)
+        && KMINES_CHECK(field.isWon() == reference.m_won);
+    // the old code kept counting after a loss
+    if(same && !reference.m_gameOver)
+        same = KMINES_CHECK(field.unrevealedCount() == reference.m_numUnrevealed);
+    if(same && reference.m_won)
+        same = KMINES_CHECK(field.flaggedCount() == field.minesCount());
+    return same;
+}
+
+/**
+ * Random input, biased to make progress: opening cells, flags on
+ * mines, some wrong flags and question marks, and chords on digits
+ */
+static void playGame(MineField& field, ReferenceField& reference, std::mt19937& random, Totals& totals)
+{
+    const int numCells = field.cellCount();
+    auto randomCell = [&random, numCells] { return std::uniform_int_distribution<int>(0, numCells-1)(random); };
+    for(int input=0; input<numCells && !field.isGameOver(); ++input)
+    {
+        int idx = randomCell();
+        const int action = std::uniform_int_distribution<int>(0, 99)(random);
+        if(action < 45)
+        {
+            field.press(idx);
+            reference.press(idx);
+            field.open(idx);
+            reference.open(idx);
+        }
+        else if(action < 65)
+        {
+            // flag a mine next to a revealed cell, for chords to work on
+            for(int i=0; i<numCells && !(field.hasMine(idx) && field.state(idx) == KMinesState::Released); ++i)
+                idx = (idx + 1) % numCells;
+            const bool useQuestionMarks = action < 50;
+            field.mark(idx, useQuestionMarks);
+            reference.mark(idx, useQuestionMarks);
+        }
+        else if(action < 75)
+        {
+            const bool useQuestionMarks = action < 70;
+            field.mark(idx, useQuestionMarks);
+            reference.mark(idx, useQuestionMarks);
+        }
+        else if(action < 95)
+        {
+            for(int i=0; i<numCells && !(field.isRevealed(idx) && field.digit(idx) != 0); ++i)
+                idx = (idx + 1) % numCells;
+            // mid button press, then release
+            for (int neighbour : field.adjacentCells(idx)) {
+                field.press(neighbour);
+                reference.press(neighbour);
+            }
+            field.chord(idx);
+            reference.chord(idx);
+        }
+        else
+        {
+            field.press(idx);
+            reference.press(idx);
+            field.undoPress(idx);
+            reference.undoPress(idx);
+        }
+        totals.inputs++;
+        if(!compare(field, reference, totals))
+        {
+            std::fprintf(stderr, "mismatch in a %dx%d game with %d mines after input %d\n",
+                         field.rowCount(), field.columnCount(), field.minesCount(), input);
+            return;
+        }
+    }
+    totals.wins += field.isWon();
+    totals.losses += field.isGameOver() && !field.isWon();
+}
+
+static void testAgainstReference(Totals& totals)
+{
+    std::mt19937 random(2026);
+    // standard levels use the FixedMineField kernels, other sizes the
+    // generic span fill
+    const int sizes[][2] = { { 9, 9 }, { 16, 16 }, { 16, 30 }, { 1, 40 }, { 40, 1 },
+                             { 7, 13 }, { 31, 17 }, { 64, 64 }, { 120, 90 } };
+    for (const auto& size : sizes) {
+        const int rows = size[0];
+        const int cols = size[1];
+        const int games = rows*cols > 2000 ? 40 : 400;
+        for(int game=0; game<games; ++game)
+        {
+            // sparse fields have large openings, dense ones many digits
+            const int density = std::uniform_int_distribution<int>(3, 30)(random);
+            MineField field;
+            field.init(rows, cols, rows*cols * density / 100);
+            const int clicked = std::uniform_int_distribution<int>(0, rows*cols-1)(random);
+            field.generate(clicked, random());
+
+            ReferenceField reference(field);
+            const auto [openings, threeBV] = reference.openingsAndThreeBV();
+            KMINES_CHECK(field.openingCount() == openings);
+            KMINES_CHECK(field.threeBV() == threeBV);
+
+            field.press(clicked);
+            reference.press(clicked);
+            field.open(clicked);
+            reference.open(clicked);
+            totals.games++;
+            if(!compare(field, reference, totals))
+                continue;
+            playGame(field, reference, random, totals);
+
+            // the same mines once more, which reuses the opening index
+            field.reset();
+            reference.reset();
+            totals.games++;
+            playGame(field, reference, random, totals);
+        }
+    }
+}
+
+/**
+ * Plays FixedMineField and MineField side by side, with flags but no
+ * question marks, which FixedMineField doesn't have
+ */
+template<int Rows, int Cols>
+static void testFixedMineField(int numMines, Totals& totals)
+{
+    std::mt19937 random(Rows*Cols);
+    const int numCells = Rows*Cols;
+    for(int game=0; game<300; ++game)
+    {
+        const int clicked = std::uniform_int_distribution<int>(0, numCells-1)(random);
+        const std::uint32_t seed = random();
+        MineField field;
+        field.init(Rows, Cols, numMines);
+        field.generate(clicked, seed);
+        FixedMineField<Rows, Cols> fixed;
+        fixed.generate(clicked, numMines, seed);
+
+        bool same = true;
+        for(int idx=0; idx<numCells && same; ++idx)
+            same = fixed.hasMine(idx) == field.hasMine(idx) && fixed.digit(idx) == field.digit(idx);
+        if(!KMINES_CHECK(same))
+            continue;
+
+        field.press(clicked);
+        field.open(clicked);
+        fixed.open(clicked);
+        for(int input=0; input<numCells && !field.isGameOver(); ++input)
+        {
+            const int idx = std::uniform_int_distribution<int>(0, numCells-1)(random);
+            const int action = std::uniform_int_distribution<int>(0, 2)(random);
+            if(action == 0)
+            {
+                field.press(idx);
+                field.open(idx);
+                fixed.open(idx);
+            }
+            else if(action == 1 && !field.isRevealed(idx))
+            {
+                field.mark(idx, false);
+                fixed.toggleFlag(idx);
+            }
+            else if(action == 2)
+            {
+                field.chord(idx);
+                fixed.chord(idx);
+            }
+            totals.inputs++;
+            // after a loss MineField also shows all mines
+            same = field.isGameOver() == (fixed.isLost() || fixed.isWon()) && field.isWon() == fixed.isWon();
+            for(int i=0; i<numCells && same && !field.isGameOver(); ++i)
+                same = field.isRevealed(i) == fixed.isRevealed(i) && field.isFlagged(i) == fixed.isFlagged(i);
+            totals.cellChecks += numCells;
+            if(!KMINES_CHECK(same))
+                break;
+        }
+        totals.games++;
+    }
+}
+
+int main()
+{
+    Totals totals;
+    testAgainstReference(totals);
+    testFixedMineField<9, 9>(10, totals);
+    testFixedMineField<16, 16>(40, totals);
+    testFixedMineField<16, 30>(99, totals);
+    std::printf("%ld games (%ld won, %ld lost against the reference), %ld inputs, %ld cell checks\n",
+                totals.games, totals.wins, totals.losses, totals.inputs, totals.cellChecks);
+    return KMinesTest::result();
+}
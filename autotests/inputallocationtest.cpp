@@ -0,0 +1,147 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Checks that the input path of MineField (press, undo press, open,
+// chord and neighbour iteration) doesn't allocate once its buffers
+// have grown, by counting calls of the global operator new
+
+// own
+#include "kminestest.h"
+#include "minefield.h"
+// Std
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+static long s_allocations = 0;
+
+void* operator new(std::size_t size)
+{
+    s_allocations++;
+    if(void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+/**
+ * Cells in the corners, in the middle of each edge and inside
+ */
+static std::vector<int> testCells(const MineField& field)
+{
+    const int rows = field.rowCount();
+    const int cols = field.columnCount();
+    return { field.index(0, 0), field.index(0, cols-1), field.index(rows-1, 0), field.index(rows-1, cols-1),
+             field.index(0, cols/2), field.index(rows-1, cols/2), field.index(rows/2, 0), field.index(rows/2, cols-1),
+             field.index(rows/2, cols/2), field.index(1, 1), field.index(rows/3, cols/4), field.index(rows-2, cols-2) };
+}
+
+struct EventStats
+{
+    int events = 0;
+    long allocations = 0;
+};
+
+/**
+ * Feeds the input events a player would cause around each test cell.
+ * If counting, checks that no event allocates
+ */
+static EventStats playEvents(MineField& field, bool counting)
+{
+    EventStats stats;
+    auto event = [&field, &stats, counting](auto&& apply) {
+        const long before = s_allocations;
+        apply();
+        // the view takes the changed cells after each event
+        field.clearChangedCells();
+        stats.events++;
+        stats.allocations += s_allocations - before;
+        if(counting)
+            KMINES_CHECK(s_allocations == before);
+    };
+
+    const std::vector<int> cells = testCells(field);
+    for (int idx : cells) {
+        event([&] { field.press(idx); });
+        event([&] { field.undoPress(idx); });
+
+        // chord hover: all neighbours pressed, then released
+        event([&] {
+            int count = 0;
+            field.forEachAdjacentCell(idx, [&count](int) { count++; });
+            KMINES_CHECK(count == field.adjacentCells(idx).size());
+        });
+        event([&] {
+            for (int neighbour : field.adjacentCells(idx)) {
+                field.press(neighbour);
+            }
+        });
+        event([&] {
+            for (int neighbour : field.adjacentCells(idx)) {
+                field.undoPress(neighbour);
+            }
+        });
+        if(field.hasMine(idx) || field.isGameOver())
+            continue;
+
+        // reveal the cell, then chord it with its mines flagged
+        event([&] { field.press(idx); });
+        event([&] { field.open(idx); });
+        for (int neighbour : field.adjacentCells(idx)) {
+            if(field.hasMine(neighbour) && !field.isFlagged(neighbour))
+                event([&] { field.mark(neighbour, false); });
+        }
+        event([&] { field.chord(idx); });
+    }
+    return stats;
+}
+
+static void testField(int rows, int cols, int numMines)
+{
+    MineField field;
+    field.init(rows, cols, numMines);
+    field.generate(field.index(rows/2, cols/2), 3);
+    // grows the buffers, then the same game once more
+    const EventStats warmUp = playEvents(field, false);
+    field.reset();
+    const EventStats stats = playEvents(field, true);
+    std::printf("%dx%d: %d input events, %ld allocations (%ld while buffers grew)\n", rows, cols,
+                stats.events, stats.allocations, warmUp.allocations);
+    KMINES_CHECK(!field.isGameOver() || field.isWon());
+}
+
+int main()
+{
+    // bitboard kernels, opening index and span fill
+    testField(16, 30, 99);
+    testField(50, 50, 300);
+    testField(300, 300, 4500);
+    return KMinesTest::result();
+}
@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef KMINESTEST_H
+#define KMINESTEST_H
+
+// Std
+#include <cmath>
+#include <cstdio>
+
+/**
+ * Minimal checks for the kminescore tests, which run without Qt
+ */
+namespace KMinesTest
+{
+    inline int failures = 0;
+
+    inline bool check(bool ok, const char* expression, const char* file, int line)
+    {
+        if(!ok)
+        {
+            std::fprintf(stderr, "FAIL %s:%d: %s\n", file, line, expression);
+            failures++;
+        }
+        return ok;
+    }
+    /**
+     * @return exit code of the test: 0 if no check failed
+     */
+    inline int result()
+    {
+        if(failures != 0)
+            std::fprintf(stderr, "%d checks failed\n", failures);
+        return failures != 0;
+    }
+    /**
+     * @return approximate quantile of the chi-square distribution with
+     * degreesOfFreedom, z being the quantile of the standard normal
+     * distribution (Wilson-Hilferty)
+     */
+    inline double chiSquareQuantile(int degreesOfFreedom, double z)
+    {
+        const double k = degreesOfFreedom;
+        const double t = 1 - 2/(9*k) + z * std::sqrt(2/(9*k));
+        return k * t*t*t;
+    }
+}
+
+#define KMINES_CHECK(condition) KMinesTest::check((condition), #condition, __FILE__, __LINE__)
+
+#endif
@@ -0,0 +1,151 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Checks that MineField::generate() places mines uniformly at random
+// and keeps the clicked cell empty
+
+// own
+#include "kminestest.h"
+#include "minefield.h"
+// Std
+#include <bit>
+#include <vector>
+
+/**
+ * Fixed seeds make the test deterministic. A uniform generator stays
+ * below the 0.999 quantile and above the 0.001 quantile of chi-square
+ */
+static const double UpperZ = 3.09;
+static const double LowerZ = -3.09;
+
+static void testClickedCellStaysEmpty()
+{
+    const int sizes[][2] = { { 9, 9 }, { 16, 30 }, { 7, 13 }, { 40, 40 } };
+    for (const auto& size : sizes) {
+        const int rows = size[0];
+        const int cols = size[1];
+        MineField field;
+        // corners, edges and interior
+        const int clicks[] = { 0, cols-1, (rows-1)*cols, rows*cols-1,
+                               cols/2, (rows/2)*cols, (rows/2)*cols + cols-1, (rows-1)*cols + cols/2,
+                               (rows/2)*cols + cols/2 };
+        for (int clicked : clicks) {
+            for(std::uint32_t seed=0; seed<200; ++seed)
+            {
+                // as dense as allowed
+                field.init(rows, cols, rows*cols);
+                field.generate(clicked, seed);
+
+                int mines = 0;
+                for(int idx=0; idx<field.cellCount(); ++idx)
+                    mines += field.hasMine(idx);
+                KMINES_CHECK(mines == field.minesCount());
+                KMINES_CHECK(!field.hasMine(clicked));
+                KMINES_CHECK(field.digit(clicked) == 0);
+                for (int neighbour : field.adjacentCells(clicked)) {
+                    KMINES_CHECK(!field.hasMine(neighbour));
+                }
+            }
+        }
+    }
+}
+
+static void testCellFrequencies()
+{
+    // Expert field, clicked inside: each of the 471 allowed cells
+    // should get a mine with the same probability
+    const int rows = 16;
+    const int cols = 30;
+    const int numMines = 99;
+    const int draws = 20000;
+    MineField field;
+    const int clicked = 5*cols + 7;
+    std::vector<int> counts(rows*cols, 0);
+    for(int seed=0; seed<draws; ++seed)
+    {
+        field.init(rows, cols, numMines);
+        field.generate(clicked, seed);
+        for(int idx=0; idx<field.cellCount(); ++idx)
+            counts[idx] += field.hasMine(idx);
+    }
+
+    const int allowed = rows*cols - 9;
+    const double p = double(numMines) / allowed;
+    const double expected = draws * p;
+    const double variance = draws * p * (1 - p);
+    double chiSquare = 0;
+    for(int idx=0; idx<rows*cols; ++idx)
+    {
+        const int row = idx / cols;
+        const int col = idx % cols;
+        if(row >= 4 && row <= 6 && col >= 6 && col <= 8)
+        {
+            KMINES_CHECK(counts[idx] == 0);
+            continue;
+        }
+        const double diff = counts[idx] - expected;
+        chiSquare += diff * diff / variance;
+    }
+    std::printf("cell frequencies: chi2 %.1f, %d degrees of freedom\n", chiSquare, allowed - 1);
+    KMINES_CHECK(chiSquare < KMinesTest::chiSquareQuantile(allowed - 1, UpperZ));
+    KMINES_CHECK(chiSquare > KMinesTest::chiSquareQuantile(allowed - 1, LowerZ));
+}
+
+static void testSubsetFrequencies()
+{
+    // 4x5 field clicked in a corner leaves 16 allowed cells, so each
+    // of the 560 sets of 3 mines should come up equally often
+    const int rows = 4;
+    const int cols = 5;
+    const int numMines = 3;
+    const int subsets = 560;
+    const int draws = subsets * 200;
+    MineField field;
+    // subset as a bitmask of cells
+    std::vector<int> counts(1 << (rows*cols), 0);
+    for(int seed=0; seed<draws; ++seed)
+    {
+        field.init(rows, cols, numMines);
+        field.generate(0, seed);
+        int mask = 0;
+        for(int idx=0; idx<field.cellCount(); ++idx)
+            mask |= field.hasMine(idx) << idx;
+        counts[mask]++;
+    }
+
+    int seen = 0;
+    double chiSquare = 0;
+    const double expected = double(draws) / subsets;
+    for(int mask=0; mask<int(counts.size()); ++mask)
+    {
+        if(std::popcount(unsigned(mask)) != numMines)
+        {
+            KMINES_CHECK(counts[mask] == 0);
+            continue;
+        }
+        // clicked corner and its neighbours
+        if(mask & ((1 << 0) | (1 << 1) | (1 << cols) | (1 << (cols+1))))
+        {
+            KMINES_CHECK(counts[mask] == 0);
+            continue;
+        }
+        seen++;
+        const double diff = counts[mask] - expected;
+        chiSquare += diff * diff / expected;
+    }
+    std::printf("subset frequencies: chi2 %.1f, %d degrees of freedom\n", chiSquare, subsets - 1);
+    KMINES_CHECK(seen == subsets);
+    KMINES_CHECK(chiSquare < KMinesTest::chiSquareQuantile(subsets - 1, UpperZ));
+    KMINES_CHECK(chiSquare > KMinesTest::chiSquareQuantile(subsets - 1, LowerZ));
+}
+
+int main()
+{
+    testClickedCellStaysEmpty();
+    testCellFrequencies();
+    testSubsetFrequencies();
+    return KMinesTest::result();
+}
@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef BENCHMARKUTILS_H
+#define BENCHMARKUTILS_H
+
+// own
+#include "minefield.h"
+// Std
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace KMinesBenchmark
+{
+    /**
+     * Runs setup() and then body() runs times, timing only body()
+     *
+     * @return fastest run in microseconds
+     */
+    template<typename Setup, typename Body>
+    double bestOf(int runs, Setup setup, Body body)
+    {
+        double best = std::numeric_limits<double>::max();
+        for(int i=0; i<runs; ++i)
+        {
+            setup();
+            const auto start = std::chrono::steady_clock::now();
+            body();
+            const auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        return best;
+    }
+
+    /**
+     * The old reveal: one call per empty cell, each building the list of
+     * its neighbours. The calls are kept on an explicit stack in the same
+     * order, as the recursion overflows the thread stack on large fields.
+     * Marks next to empty cells are not looked at
+     *
+     * @return number of cells revealed, clicked included
+     */
+    inline int revealRecursively(const MineField& field, std::vector<bool>& revealed, int clicked)
+    {
+        const int cols = field.columnCount();
+        const int rows = field.rowCount();
+        int numRevealed = 1;
+        revealed[clicked] = true;
+        struct Call
+        {
+            std::vector<int> neighbours;
+            std::size_t next;
+        };
+        std::vector<Call> calls;
+        auto enter = [&calls, rows, cols](int idx) {
+            const int row = idx / cols;
+            const int col = idx % cols;
+            std::vector<int> neighbours;
+            for(int r = row-1; r <= row+1; ++r)
+                for(int c = col-1; c <= col+1; ++c)
+                    if((r != row || c != col) && r >= 0 && r < rows && c >= 0 && c < cols)
+                        neighbours.push_back(r*cols + c);
+            calls.push_back({ std::move(neighbours), 0 });
+        };
+        enter(clicked);
+        while(!calls.empty())
+        {
+            Call& call = calls.back();
+            if(call.next == call.neighbours.size())
+            {
+                calls.pop_back();
+                continue;
+            }
+            const int idx = call.neighbours[call.next++];
+            if(revealed[idx])
+                continue;
+            revealed[idx] = true;
+            numRevealed++;
+            if(field.digit(idx) == 0)
+                enter(idx);
+        }
+        return numRevealed;
+    }
+}
+
+#endif
@@ -0,0 +1,150 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Times MineField::chord() on revealed digits with correctly flagged
+// mines around them, up to the largest custom size, see kmines.kcfg.
+// For reference, the chord MineFieldItem did before: a neighbour list
+// per chord, and per revealed neighbour a search of its item in the
+// list of all cells and a scan of all cells for an explosion
+
+// own
+#include "benchmarkutils.h"
+#include "minefield.h"
+// Std
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * Cell states of the old chord, kept apart from MineField
+ */
+struct OldField
+{
+    const MineField& field;
+    std::vector<bool> revealed;
+    std::vector<bool> flagged;
+    std::vector<bool> exploded;
+    /**
+     * Stands in for the list of cell items, which got searched linearly
+     */
+    std::vector<int> items;
+    int numUnrevealed = 0;
+};
+
+static void chordOld(OldField& old, int idx)
+{
+    const MineField& field = old.field;
+    const int row = idx / field.columnCount();
+    const int col = idx % field.columnCount();
+    std::vector<int> neighbours;
+    for(int r = row-1; r <= row+1; ++r)
+        for(int c = col-1; c <= col+1; ++c)
+            if((r != row || c != col) && r >= 0 && r < field.rowCount() && c >= 0 && c < field.columnCount())
+                neighbours.push_back(field.index(r, c));
+    if(!old.revealed[idx])
+        return;
+
+    int numFlags = 0;
+    int numMines = 0;
+    for (int neighbour : neighbours) {
+        numFlags += old.flagged[neighbour];
+        numMines += field.hasMine(neighbour);
+    }
+    if(numFlags != numMines || numFlags == 0)
+        return;
+    for (int neighbour : neighbours) {
+        if(old.revealed[neighbour] || old.flagged[neighbour])
+            continue;
+        old.exploded[neighbour] = field.hasMine(neighbour);
+        // onItemRevealed(item): find the item's position first
+        const int pos = static_cast<int>(std::find(old.items.begin(), old.items.end(), neighbour) - old.items.begin());
+        old.numUnrevealed--;
+        if(field.digit(pos) == 0)
+        {
+            old.revealed[pos] = false;
+            old.numUnrevealed -= KMinesBenchmark::revealRecursively(field, old.revealed, pos) - 1;
+        }
+        old.revealed[pos] = true;
+        // checkLost() looked at every cell
+        if(std::find(old.exploded.begin(), old.exploded.end(), true) != old.exploded.end())
+            break;
+        if(old.numUnrevealed == field.minesCount())
+            break;
+    }
+}
+
+static void benchmark(int rows, int cols, int numChords, int runs)
+{
+    MineField field;
+    field.init(rows, cols, rows*cols / 5);
+    field.generate(field.index(rows/2, cols/2), 1);
+
+    // unrevealed digits, each to be opened and chorded
+    std::mt19937 random(2);
+    std::uniform_int_distribution<int> cell(0, field.cellCount() - 1);
+    std::vector<int> chorded;
+    std::vector<bool> taken(field.cellCount(), false);
+    for(int tries=0; int(chorded.size()) < numChords && tries < 100 * numChords; ++tries)
+    {
+        const int idx = cell(random);
+        if(field.hasMine(idx) || field.digit(idx) == 0 || taken[idx])
+            continue;
+        taken[idx] = true;
+        chorded.push_back(idx);
+    }
+
+    auto setUp = [&field, &chorded] {
+        field.reset();
+        for (int idx : chorded) {
+            for (int neighbour : field.adjacentCells(idx)) {
+                if(field.hasMine(neighbour) && !field.isFlagged(neighbour))
+                    field.mark(neighbour, false);
+            }
+            field.press(idx);
+            field.open(idx);
+        }
+    };
+    const double newUs = KMinesBenchmark::bestOf(runs, setUp, [&field, &chorded] {
+        for (int idx : chorded) {
+            field.chord(idx);
+        }
+    });
+    const int newRevealed = field.cellCount() - field.unrevealedCount();
+
+    OldField old{ field, {}, {}, {}, {}, 0 };
+    const double oldUs = KMinesBenchmark::bestOf(runs, [&old, &field, &setUp] {
+        setUp();
+        old.revealed.assign(field.cellCount(), false);
+        old.flagged.assign(field.cellCount(), false);
+        old.exploded.assign(field.cellCount(), false);
+        old.items.resize(field.cellCount());
+        for(int idx=0; idx<field.cellCount(); ++idx)
+        {
+            old.items[idx] = idx;
+            old.revealed[idx] = field.isRevealed(idx);
+            old.flagged[idx] = field.isFlagged(idx);
+        }
+        old.numUnrevealed = field.unrevealedCount();
+    }, [&old, &chorded] {
+        for (int idx : chorded) {
+            chordOld(old, idx);
+        }
+    });
+    const int oldRevealed = field.cellCount() - old.numUnrevealed;
+
+    std::printf("%5dx%-5d %6zu chords   per-neighbour chord %10.3f us   MineField %7.3f us per chord%s\n",
+                rows, cols, chorded.size(), oldUs / chorded.size(), newUs / chorded.size(),
+                oldRevealed == newRevealed ? "" : "   MISMATCH");
+}
+
+int main()
+{
+    benchmark(16, 30, 20, 200);
+    benchmark(256, 256, 1000, 5);
+    benchmark(2000, 2000, 100, 3);
+    return 0;
+}
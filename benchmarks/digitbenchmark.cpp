@@ -0,0 +1,114 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Times computing the digits of a whole field: the row kernel of
+// KMinesKernels, the bitboard kernel of FixedMineField for the Expert
+// size, and incrementing the neighbours of each mine for reference
+
+// own
+#include "benchmarkutils.h"
+#include "fixedminefield.h"
+#include "neighbourcount.h"
+// Std
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * Mine flags of a field, one padded byte row per field row as taken
+ * by KMinesKernels::countNeighbourMines()
+ */
+struct Rows
+{
+    int numRows;
+    int numCols;
+    std::vector<std::uint8_t> bytes;
+
+    int stride() const { return numCols + 2; }
+    const std::uint8_t* row(int r) const { return bytes.data() + (r + 1) * stride(); }
+};
+
+static Rows randomRows(int numRows, int numCols, double density)
+{
+    Rows rows{ numRows, numCols, std::vector<std::uint8_t>(std::size_t(numRows + 2) * (numCols + 2), 0) };
+    std::mt19937 random(1);
+    std::bernoulli_distribution mine(density);
+    for(int r=0; r<numRows; ++r)
+        for(int c=0; c<numCols; ++c)
+            rows.bytes[std::size_t(r + 1) * rows.stride() + c + 1] = mine(random);
+    return rows;
+}
+
+static void countRowKernel(const Rows& rows, std::vector<std::uint8_t>& digits)
+{
+    for(int r=0; r<rows.numRows; ++r)
+        KMinesKernels::countNeighbourMines(rows.row(r - 1), rows.row(r), rows.row(r + 1),
+                                           digits.data() + std::size_t(r) * rows.numCols, rows.numCols);
+}
+
+static void countPerMine(const Rows& rows, std::vector<std::uint8_t>& digits)
+{
+    std::fill(digits.begin(), digits.end(), 0);
+    for(int r=0; r<rows.numRows; ++r)
+        for(int c=0; c<rows.numCols; ++c)
+        {
+            if(!rows.row(r)[c + 1])
+                continue;
+            for(int dr=-1; dr<=1; ++dr)
+                for(int dc=-1; dc<=1; ++dc)
+                {
+                    const int nr = r + dr;
+                    const int nc = c + dc;
+                    if(nr >= 0 && nr < rows.numRows && nc >= 0 && nc < rows.numCols && !rows.row(nr)[nc + 1])
+                        digits[std::size_t(nr) * rows.numCols + nc]++;
+                }
+        }
+}
+
+static void benchmark(int numRows, int numCols, double density, int runs)
+{
+    const Rows rows = randomRows(numRows, numCols, density);
+    std::vector<std::uint8_t> kernelDigits(std::size_t(numRows) * numCols);
+    std::vector<std::uint8_t> perMineDigits(kernelDigits.size());
+
+    const double kernel = KMinesBenchmark::bestOf(runs, [] {}, [&] { countRowKernel(rows, kernelDigits); });
+    const double perMine = KMinesBenchmark::bestOf(runs, [] {}, [&] { countPerMine(rows, perMineDigits); });
+    std::printf("%5dx%-5d %3.0f%% mines   per-mine loop %10.1f us   row kernel %9.1f us%s\n",
+                numRows, numCols, density * 100, perMine, kernel,
+                kernelDigits == perMineDigits ? "" : "   MISMATCH");
+}
+
+static void benchmarkExpertBitboard()
+{
+    using Field = FixedMineField<16, 30>;
+    const Rows rows = randomRows(16, 30, 99.0 / 480);
+    Field::Word mines[Field::WordCount] = {};
+    for(int idx=0; idx<Field::CellCount; ++idx)
+        if(rows.row(idx / 30)[idx % 30 + 1])
+            mines[idx >> 6] |= Field::Word(1) << (idx & 63);
+
+    Field::Word planes[4 * Field::WordCount];
+    const int repeat = 1000;
+    const double us = KMinesBenchmark::bestOf(20, [] {}, [&] {
+        for(int i=0; i<repeat; ++i)
+        {
+            Field::countNeighbours(mines, planes);
+            // keeps the compiler from hoisting the call
+            mines[i % Field::WordCount] ^= planes[0] & 1;
+        }
+    });
+    std::printf("   16x30    bitboard kernel %.3f us\n", us / repeat);
+}
+
+int main()
+{
+    benchmark(16, 30, 99.0 / 480, 200);
+    benchmarkExpertBitboard();
+    benchmark(256, 256, 0.2, 50);
+    benchmark(4096, 4096, 0.2, 5);
+    return 0;
+}
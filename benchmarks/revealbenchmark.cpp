@@ -0,0 +1,63 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Times the cascade of a single click into a large opening: through the
+// opening index, through the span fill of MineField::revealEmptySpace(),
+// and with the recursive reveal MineFieldItem used before for reference.
+// On the Expert size the fallback is the FixedMineField fill instead of
+// the span fill
+
+// own
+#include "benchmarkutils.h"
+#include "minefield.h"
+// Std
+#include <cstdio>
+#include <vector>
+
+static void benchmark(int rows, int cols, int runs)
+{
+    MineField field;
+    field.init(rows, cols, rows*cols / 20);
+    const int clicked = field.index(rows/2, cols/2);
+    field.generate(clicked, 1);
+
+    auto click = [&field, clicked] {
+        field.press(clicked);
+        field.open(clicked);
+    };
+    const double indexUs = KMinesBenchmark::bestOf(runs, [&field] { field.reset(); }, click);
+    const int numRevealed = field.cellCount() - field.unrevealedCount();
+
+    // a question mark inside the opening makes the index step aside
+    int blocker = 0;
+    while(blocker == clicked || !field.isRevealed(blocker) || field.digit(blocker) != 0)
+        blocker++;
+    const double spanFillUs = KMinesBenchmark::bestOf(runs, [&field, blocker] {
+        field.reset();
+        field.mark(blocker, true);
+        field.mark(blocker, true);
+    }, click);
+    const int numSpanFilled = field.cellCount() - field.unrevealedCount();
+
+    std::vector<bool> revealed;
+    int numRecursive = 0;
+    const double recursiveUs = KMinesBenchmark::bestOf(runs, [&field, &revealed] {
+        revealed.assign(field.cellCount(), false);
+    }, [&] { numRecursive = KMinesBenchmark::revealRecursively(field, revealed, clicked); });
+
+    std::printf("%5dx%-5d %7d cells   recursive %9.2f ms   span fill %8.2f ms   opening index %8.2f ms%s\n",
+                rows, cols, numRevealed, recursiveUs / 1000, spanFillUs / 1000, indexUs / 1000,
+                numRecursive == numRevealed && numSpanFilled >= numRevealed - 1 ? "" : "   MISMATCH");
+}
+
+int main()
+{
+    benchmark(16, 30, 200);
+    benchmark(100, 100, 50);
+    benchmark(1000, 1000, 5);
+    benchmark(2000, 2000, 3);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+// Prerenders the sprites of a theme into a SpriteAtlas file at build time
+
+// own
+#include "spriteatlas.h"
+// Qt
+#include <QCommandLineParser>
+#include <QGuiApplication>
+#include <QImage>
+#include <QPainter>
+#include <QSaveFile>
+#include <QSvgRenderer>
+// Std
+#include <cmath>
+#include <cstring>
+
+struct RenderedSprite
+{
+    QString key;
+    int page;
+    QRect rect;
+};
+
+static SpriteAtlas::FileSprite fileSprite(const RenderedSprite& sprite)
+{
+    SpriteAtlas::FileSprite result;
+    std::memset(&result, 0, sizeof(result));
+    const QByteArray key = sprite.key.toLatin1();
+    std::memcpy(result.key, key.constData(), qMin<size_t>(key.size(), sizeof(result.key) - 1));
+    result.page = sprite.page;
+    result.x = sprite.rect.x();
+    result.y = sprite.rect.y();
+    result.width = sprite.rect.width();
+    result.height = sprite.rect.height();
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    // no display is needed for rendering into images
+    if(qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    QGuiApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral( "Prerenders KMines theme sprites into an atlas" ));
+    parser.addHelpOption();
+    const QCommandLineOption sizesOption(QStringLiteral( "sizes" ),
+                                         QStringLiteral( "Comma separated cell sizes to render at" ),
+                                         QStringLiteral( "sizes" ), QStringLiteral( "24,32,48,64" ));
+    const QCommandLineOption backgroundOption(QStringLiteral( "background" ),
+                                              QStringLiteral( "Size of the background, as WIDTHxHEIGHT" ),
+                                              QStringLiteral( "size" ), QStringLiteral( "512x384" ));
+    parser.addOption(sizesOption);
+    parser.addOption(backgroundOption);
+    parser.addPositionalArgument(QStringLiteral( "svg" ), QStringLiteral( "Theme SVG file" ));
+    parser.addPositionalArgument(QStringLiteral( "atlas" ), QStringLiteral( "Atlas file to write" ));
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    if(args.size() != 2)
+        parser.showHelp(1);
+
+    QSvgRenderer svg(args[0]);
+    if(!svg.isValid())
+    {
+        qCritical("Cannot load %s", qPrintable(args[0]));
+        return 1;
+    }
+
+    QList<QImage> pages;
+    QList<RenderedSprite> sprites;
+
+    // one page per cell size, sprites in a grid of square tiles
+    QStringList cellSprites;
+    const QStringList allCellSprites = SpriteAtlas::cellSprites();
+    for (const QString& key : allCellSprites) {
+        // themes may leave out some of them, those are rendered at runtime
+        if(svg.elementExists(key))
+            cellSprites.append(key);
+    }
+    const int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(cellSprites.size()))));
+    const int rows = columns > 0 ? (cellSprites.size() + columns - 1) / columns : 0;
+    const QStringList sizes = parser.value(sizesOption).split(QLatin1Char(','), Qt::SkipEmptyParts);
+    for (const QString& sizeText : sizes) {
+        const int size = sizeText.toInt();
+        if(size <= 0 || columns == 0)
+            continue;
+        QImage page(columns * size, rows * size, QImage::Format_ARGB32_Premultiplied);
+        page.fill(Qt::transparent);
+        QPainter painter(&page);
+        for(int i=0; i<cellSprites.size(); ++i)
+        {
+            const QRect rect((i % columns) * size, (i / columns) * size, size, size);
+            svg.render(&painter, cellSprites[i], rect);
+            sprites.append({ cellSprites[i], static_cast<int>(pages.size()), rect });
+        }
+        painter.end();
+        pages.append(page);
+    }
+
+    const QStringList backgroundSize = parser.value(backgroundOption).split(QLatin1Char('x'));
+    if(backgroundSize.size() == 2 && svg.elementExists(SpriteAtlas::backgroundSprite()))
+    {
+        const QRect rect(0, 0, backgroundSize[0].toInt(), backgroundSize[1].toInt());
+        if(!rect.isEmpty())
+        {
+            QImage page(rect.size(), QImage::Format_ARGB32_Premultiplied);
+            page.fill(Qt::transparent);
+            QPainter painter(&page);
+            svg.render(&painter, SpriteAtlas::backgroundSprite(), rect);
+            painter.end();
+            sprites.append({ SpriteAtlas::backgroundSprite(), static_cast<int>(pages.size()), rect });
+            pages.append(page);
+        }
+    }
+
+    SpriteAtlas::FileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, "KMAT", 4);
+    header.byteOrderMark = SpriteAtlas::ByteOrderMark;
+    header.version = SpriteAtlas::FileVersion;
+    header.pageCount = pages.size();
+    header.spriteCount = sprites.size();
+
+    // pixels follow the tables, each page aligned for mapping
+    const int alignment = 64;
+    quint64 offset = sizeof(header) + pages.size() * sizeof(SpriteAtlas::FilePage)
+                     + sprites.size() * sizeof(SpriteAtlas::FileSprite);
+    QList<SpriteAtlas::FilePage> filePages;
+    for (const QImage& page : std::as_const(pages)) {
+        offset = (offset + alignment - 1) / alignment * alignment;
+        filePages.append({ offset, static_cast<quint32>(page.width()), static_cast<quint32>(page.height()) });
+        offset += quint64(page.width()) * page.height() * 4;
+    }
+
+    QSaveFile file(args[1]);
+    if(!file.open(QIODevice::WriteOnly))
+    {
+        qCritical("Cannot write %s", qPrintable(args[1]));
+        return 1;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const SpriteAtlas::FilePage& page : std::as_const(filePages)) {
+        file.write(reinterpret_cast<const char*>(&page), sizeof(page));
+    }
+    for (const RenderedSprite& sprite : std::as_const(sprites)) {
+        const SpriteAtlas::FileSprite entry = fileSprite(sprite);
+        file.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+    }
+    for(int i=0; i<pages.size(); ++i)
+    {
+        file.write(QByteArray(filePages[i].offset - file.pos(), '\0'));
+        const QImage& page = pages[i];
+        for(int y=0; y<page.height(); ++y)
+            file.write(reinterpret_cast<const char*>(page.constScanLine(y)), page.width() * 4);
+    }
+    if(!file.commit())
+    {
+        qCritical("Cannot write %s", qPrintable(args[1]));
+        return 1;
+    }
+    return 0;
+}
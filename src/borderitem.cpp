@@ -7,42 +7,100 @@
 
 #include "borderitem.h"
 
+// own
+#include "spriteclient.h"
+// Qt
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+
 QHash<KMinesState::BorderElement, QString> BorderItem::s_elementNames;
 
 BorderItem::BorderItem( KGameRenderer* renderer, QGraphicsItem* parent )
-    : KGameRenderedItem(renderer, QString(), parent), m_element(KMinesState::BorderEast),
-      m_row(-1), m_col(-1)
+    : QGraphicsItem(parent)
 {
     if(s_elementNames.isEmpty())
         fillNameHash();
-    setShapeMode(BoundingRectShape);
+    for (auto it = s_elementNames.constBegin(); it != s_elementNames.constEnd(); ++it) {
+        m_sprites.insert(it.key(), new SpriteClient(renderer, it.value(), [this] { update(); }));
+    }
+    // only the exposed part of the frame is drawn
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+BorderItem::~BorderItem()
+{
+    qDeleteAll(m_sprites);
 }
 
-void BorderItem::setBorderType(KMinesState::BorderElement e)
+void BorderItem::setFieldSize(int numRows, int numCols)
 {
-    m_element = e;
-    updatePixmap();
+    prepareGeometryChange();
+    m_numRows = numRows;
+    m_numCols = numCols;
 }
 
-void BorderItem::setRowCol(int row, int col)
+void BorderItem::setCellSize(int cellSize, qreal dpr)
 {
-    m_row = row;
-    m_col = col;
+    if(cellSize == m_cellSize && dpr == m_dpr)
+        return;
+    if(cellSize != m_cellSize)
+        prepareGeometryChange();
+    m_cellSize = cellSize;
+    m_dpr = dpr;
+    for (SpriteClient* sprite : std::as_const(m_sprites)) {
+        sprite->setRenderSize(QSize(m_cellSize, m_cellSize), m_dpr);
+    }
 }
 
-int BorderItem::row() const
+bool BorderItem::isReady() const
 {
-    return m_row;
+    for (const SpriteClient* sprite : m_sprites) {
+        if(!sprite->isReady())
+            return false;
+    }
+    return true;
 }
 
-int BorderItem::col() const
+QRectF BorderItem::boundingRect() const
 {
-    return m_col;
+    // +2 - because of border on each side
+    return QRectF(0, 0, m_cellSize*(m_numCols+2), m_cellSize*(m_numRows+2));
 }
 
-void BorderItem::updatePixmap()
+void BorderItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
 {
-    setSpriteKey(s_elementNames[m_element]);
+    Q_UNUSED(widget);
+    // pieces of another size don't line up, wait for all of them
+    for (const SpriteClient* sprite : std::as_const(m_sprites)) {
+        if(!sprite->hasPixmap())
+            return;
+    }
+
+    const QRectF exposed = option->exposedRect;
+    const qreal size = m_cellSize;
+    const qreal right = size*(m_numCols+1);
+    const qreal bottom = size*(m_numRows+1);
+
+    auto drawCorner = [&](KMinesState::BorderElement e, qreal x, qreal y) {
+        if(exposed.intersects(QRectF(x, y, size, size)))
+            painter->drawPixmap(QPointF(x, y), m_sprites.value(e)->pixmap());
+    };
+    // tiles the edge pixmap over the exposed part of the strip,
+    // keeping tiles aligned to the cells
+    auto drawEdge = [&](KMinesState::BorderElement e, const QRectF& strip) {
+        const QRectF visible = strip.intersected(exposed);
+        if(!visible.isEmpty())
+            painter->drawTiledPixmap(visible, m_sprites.value(e)->pixmap(), visible.topLeft() - strip.topLeft());
+    };
+
+    drawCorner(KMinesState::BorderCornerNW, 0, 0);
+    drawCorner(KMinesState::BorderCornerNE, right, 0);
+    drawCorner(KMinesState::BorderCornerSW, 0, bottom);
+    drawCorner(KMinesState::BorderCornerSE, right, bottom);
+    drawEdge(KMinesState::BorderNorth, QRectF(size, 0, right - size, size));
+    drawEdge(KMinesState::BorderSouth, QRectF(size, bottom, right - size, size));
+    drawEdge(KMinesState::BorderWest, QRectF(0, size, size, bottom - size));
+    drawEdge(KMinesState::BorderEast, QRectF(right, size, size, bottom - size));
 }
 
 int BorderItem::type() const
@@ -10,34 +10,58 @@
 
 // own
 #include "commondefs.h"
-// KDEGames
-#include <KGameRenderedItem>
+// Qt
+#include <QGraphicsItem>
+#include <QHash>
 
 class KGameRenderer;
+class SpriteClient;
 
 /**
- * Graphics item representing border cell
+ * Graphics item drawing the whole border around the field as a
+ * nine-slice frame: corner sprites at the corners, edge sprites
+ * tiled along the sides. The item covers the field including its
+ * border, one cell wide on each side; the inside is left empty.
+ *
+ * Sprites are rendered asynchronously once per cell size, so the cost
+ * doesn't depend on field dimensions. Until they arrive, the border is
+ * not drawn.
  */
-class BorderItem : public KGameRenderedItem
+class BorderItem : public QGraphicsItem
 {
 public:
     BorderItem( KGameRenderer* renderer, QGraphicsItem* parent );
-    void setBorderType( KMinesState::BorderElement e );
-    void setRowCol( int row, int col );
-    Q_REQUIRED_RESULT int row() const;
-    Q_REQUIRED_RESULT int col() const;
-    void updatePixmap();
+    ~BorderItem() override;
+    /**
+     * Sets number of field rows and columns, not counting the border
+     */
+    void setFieldSize( int numRows, int numCols );
+    /**
+     * Sets size of one border tile, which is the size of a cell,
+     * and requests the sprites at that size for a screen with given
+     * device pixel ratio
+     */
+    void setCellSize( int cellSize, qreal dpr = 1.0 );
+    /**
+     * @return true if all sprites are rendered for the current cell size
+     */
+    bool isReady() const;
+
+    QRectF boundingRect() const override;
+    void paint( QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr ) override;
 
     // enable use of qgraphicsitem_cast
-    enum { Type = UserType + 1 };
+    enum { Type = UserType + 2 };
     Q_REQUIRED_RESULT int type() const override;
 private:
     static QHash<KMinesState::BorderElement, QString> s_elementNames;
     static void fillNameHash();
 
-    KMinesState::BorderElement m_element;
-    int m_row = -1;
-    int m_col = -1;
+    QHash<KMinesState::BorderElement, SpriteClient*> m_sprites;
+    int m_numRows = 1;
+    int m_numCols = 1;
+    int m_cellSize = 0;
+    qreal m_dpr = 1.0;
 };
 
 #endif
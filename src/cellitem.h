@@ -10,123 +10,89 @@
 
 // own
 #include "commondefs.h"
-// KDEGames
-#include <KGameRenderedItem>
+// Qt
+#include <QGraphicsPixmapItem>
 
-class KGameRenderer;
+class CellPixmapCache;
 
 /**
  * Graphics item representing single cell on
  * the game field.
- * Handles clicks, emits signals when something important happens :)
+ * Only displays the cell, game logic lives in MineField.
+ * The cell with all its overlays is drawn as one pixmap
+ * taken from CellPixmapCache
  */
-class CellItem : public KGameRenderedItem
+class CellItem : public QGraphicsPixmapItem
 {
 public:
-    CellItem(KGameRenderer* renderer, QGraphicsItem* parent);
     /**
-     * Updates item pixmap according to its current
-     * state and properties
+     * @param cache cache providing the pixmaps, shared by all cells
+     * @param index index of the cell in MineField, see index()
      */
-    void updatePixmap();
+    CellItem(CellPixmapCache* cache, int index, QGraphicsItem* parent);
+    ~CellItem() override;
     /**
-     * Reimplemented to pass the call on to any child items as well
+     * @return index of the displayed cell in MineField.
+     * Lets event handlers map an item back to its cell without
+     * searching the item list
      */
-    void setRenderSize(const QSize &renderSize);
-    // FIXME: will it EVER be needed to setHasMine(false)???
+    int index() const { return m_index; }
     /**
-     * Sets whether this item holds mine or not
+     * Moves the item to another cell, when it is recycled while scrolling
      */
-    void setHasMine(bool hasMine);
+    void setIndex(int index) { m_index = index; }
     /**
-     * @return whether this item holds mine
+     * Updates item pixmap according to its current
+     * state and properties. Call after the cache got
+     * resized or cleared
      */
-    bool hasMine() const;
+    void updatePixmap();
     /**
-     * Sets this item so it holds a digit
+     * Sets what this item displays. Pixmap is updated
+     * only if something has actually changed
      *
-     * @param digit digit number (1 to 8)
-     */
-    void setDigit(int digit);
-    /**
-     * @return digit this item holds or 0 if none
-     */
-    int digit() const;
-    /**
-     * Shows what this item hides :)
-     * Can be a bomb, a digit, an empty square
-     */
-    void reveal();
-    /**
-     * Hides what this item shows ;).
-     * I.e. resets revealed state
-     */
-    void unreveal();
-    /**
-     * Removes the flag
-     */
-    void unflag();
-    /**
-     * Stops the mine from being exploded
-     */
-    void unexplode();
-    /**
-     * @return whether this cell is revealed
+     * @param state state of the cell
+     * @param digit digit the cell holds (1 to 8) or 0 if none
+     * @param hasMine whether the cell holds mine
+     * @param exploded whether the mine in the cell is exploded
      */
-    bool isRevealed() const;
-    /**
-     * @return whether this cell is marked with flag
-     */
-    bool isFlagged() const;
-    /**
-     * @return whether this cell is marked with question
-     */
-    bool isQuestioned() const;
-    /**
-     * @return whether this cell is exploded
-     */
-    bool isExploded() const;
-    /**
-     * Resets all properties & state of an item to default ones
-     */
-    void reset();
-    // TODO docs
-    void press();
-    void release(bool force=false);
-    void undoPress();
-    void mark();
+    void setCellState(KMinesState::CellState state, int digit, bool hasMine, bool exploded);
     // enable use of qgraphicsitem_cast
     enum { Type = UserType + 1 };
     int type() const override;
-Q_SIGNALS:
     /**
-     * Emitted when this item is revealed with mouse click
+     * @return number of cell items created since program start
      */
-    void revealed();
+    static int createdItemCount() { return s_createdItems; }
+    /**
+     * @return number of cell items destroyed since program start
+     */
+    static int destroyedItemCount() { return s_destroyedItems; }
 private:
-    static QHash<int, QString> s_digitNames;
-    static QHash<KMinesState::CellState, QList<QString> > s_stateNames;
-    static void fillNameHashes();
+    static int s_createdItems;
+    static int s_destroyedItems;
+
+    CellPixmapCache* m_cache;
+    /**
+     * See index()
+     */
+    int m_index;
     /**
      * Current state of this item
      */
-    KMinesState::CellState m_state;
+    KMinesState::CellState m_state = KMinesState::Released;
     /**
      * True if this item holds mine
      */
-    bool m_hasMine;
+    bool m_hasMine = false;
     /**
      * True if mine is exploded
      */
-    bool m_exploded;
+    bool m_exploded = false;
     /**
      * Specifies a digit this item holds. 0 if none
      */
-    int m_digit;
-    /**
-     * Add a child object to display an overlayed pixmap
-     */
-    void addOverlay(const QString& spriteKey);
+    int m_digit = 0;
 };
 
 #endif
@@ -0,0 +1,219 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "cellpixmapcache.h"
+
+// own
+#include "spriteclient.h"
+// Qt
+#include <QPainter>
+
+QHash<int, QString> CellPixmapCache::s_digitNames;
+QHash<KMinesState::CellState, QStringList> CellPixmapCache::s_stateNames;
+
+CellPixmapCache::CellPixmapCache(KGameRenderer* renderer, const std::function<void()>& onSpritesChanged)
+    : m_onSpritesChanged(onSpritesChanged)
+{
+    if(s_digitNames.isEmpty())
+        fillNameHashes();
+
+    QStringList keys = s_digitNames.values();
+    for (const QStringList& stateKeys : std::as_const(s_stateNames)) {
+        keys += stateKeys;
+    }
+    keys << QStringLiteral( "explosion" ) << QStringLiteral( "mine" );
+    for (const QString& spriteKey : std::as_const(keys)) {
+        if(!m_sprites.contains(spriteKey))
+            m_sprites.insert(spriteKey, new SpriteClient(renderer, spriteKey, [this] { onSpriteChanged(); }));
+    }
+}
+
+CellPixmapCache::~CellPixmapCache()
+{
+    qDeleteAll(m_sprites);
+}
+
+QPixmap CellPixmapCache::pixmap(int key)
+{
+    if(m_size.isEmpty())
+        return QPixmap();
+
+    auto it = m_pixmaps.constFind(key);
+    if(it != m_pixmaps.constEnd())
+        return it.value();
+
+    it = m_placeholders.constFind(key);
+    if(it != m_placeholders.constEnd())
+        return it.value();
+
+    // sprites of another size or scaled from the atlas still beat a
+    // plain placeholder
+    bool ready = true;
+    const QStringList keys = spriteKeys(key);
+    for (const QString& spriteKey : keys) {
+        const SpriteClient* sprite = m_sprites.value(spriteKey);
+        if(!sprite->isReady() && sprite->pixmap().isNull())
+            return placeholder(key);
+        ready = ready && sprite->isReady();
+    }
+
+    QPixmap result = createPixmap();
+    result.fill(Qt::transparent);
+    QPainter p(&result);
+    p.setRenderHint(QPainter::SmoothPixmapTransform);
+    for (const QString& spriteKey : keys) {
+        p.drawPixmap(QRect(QPoint(0, 0), m_size), m_sprites.value(spriteKey)->pixmap());
+    }
+    p.end();
+
+    if(ready)
+        m_pixmaps.insert(key, result);
+    else
+        m_placeholders.insert(key, result);
+    return result;
+}
+
+QPixmap CellPixmapCache::placeholder(int key)
+{
+    const auto state = static_cast<KMinesState::CellState>(key & 7);
+    const int digit = (key >> 3) & 0xF;
+    const bool hasMine = (key >> 7) & 1;
+
+    // just enough to keep playing until the sprites arrive
+    QString text;
+    bool raised = true;
+    switch(state)
+    {
+        case KMinesState::Revealed:
+            raised = false;
+            if(digit != 0)
+                text = QString::number(digit);
+            else if(hasMine)
+                text = QStringLiteral( "*" );
+            break;
+        case KMinesState::Pressed:
+            raised = false;
+            break;
+        case KMinesState::Error:
+            raised = false;
+            text = QStringLiteral( "x" );
+            break;
+        case KMinesState::Flagged:
+            text = QStringLiteral( "!" );
+            break;
+        case KMinesState::Questioned:
+            text = QStringLiteral( "?" );
+            break;
+        default:
+            break;
+    }
+
+    QPixmap result = createPixmap();
+    result.fill(raised ? QColor(0xa0, 0xa0, 0xa0) : QColor(0xe0, 0xe0, 0xe0));
+    QPainter p(&result);
+    p.setPen(QColor(0x60, 0x60, 0x60));
+    p.drawRect(0, 0, m_size.width()-1, m_size.height()-1);
+    if(!text.isEmpty())
+    {
+        QFont font = p.font();
+        font.setPixelSize(qMax(1, m_size.height() * 2 / 3));
+        p.setFont(font);
+        p.drawText(QRect(QPoint(0, 0), m_size), Qt::AlignCenter, text);
+    }
+    p.end();
+
+    m_placeholders.insert(key, result);
+    return result;
+}
+
+QPixmap CellPixmapCache::createPixmap() const
+{
+    // painted in logical coordinates like the sprites
+    QPixmap result(deviceSize());
+    result.setDevicePixelRatio(m_dpr);
+    return result;
+}
+
+void CellPixmapCache::setRenderSize(const QSize& size, qreal dpr)
+{
+    if(size == m_size && dpr == m_dpr)
+        return;
+    m_size = size;
+    m_dpr = dpr;
+    clear();
+    for (SpriteClient* sprite : std::as_const(m_sprites)) {
+        sprite->setRenderSize(size, dpr);
+    }
+}
+
+bool CellPixmapCache::isReady() const
+{
+    for (const SpriteClient* sprite : m_sprites) {
+        if(!sprite->isReady())
+            return false;
+    }
+    return true;
+}
+
+void CellPixmapCache::clear()
+{
+    m_pixmaps.clear();
+    m_placeholders.clear();
+}
+
+void CellPixmapCache::onSpriteChanged()
+{
+    // pixmaps may contain the previous version of the sprite
+    clear();
+    m_onSpritesChanged();
+}
+
+QStringList CellPixmapCache::spriteKeys(int key)
+{
+    const auto state = static_cast<KMinesState::CellState>(key & 7);
+    const int digit = (key >> 3) & 0xF;
+    const bool hasMine = (key >> 7) & 1;
+    const bool exploded = (key >> 8) & 1;
+
+    QStringList keys = s_stateNames[state];
+    if(state == KMinesState::Revealed)
+    {
+        if(digit != 0)
+            keys.append(s_digitNames[digit]);
+        else if(hasMine)
+        {
+            if(exploded)
+                keys.append(QStringLiteral( "explosion" ));
+            keys.append(QStringLiteral( "mine" ));
+        }
+    }
+    return keys;
+}
+
+void CellPixmapCache::fillNameHashes()
+{
+    s_digitNames[1] = QStringLiteral( "arabicOne" );
+    s_digitNames[2] = QStringLiteral( "arabicTwo" );
+    s_digitNames[3] = QStringLiteral( "arabicThree" );
+    s_digitNames[4] = QStringLiteral( "arabicFour" );
+    s_digitNames[5] = QStringLiteral( "arabicFive" );
+    s_digitNames[6] = QStringLiteral( "arabicSix" );
+    s_digitNames[7] = QStringLiteral( "arabicSeven" );
+    s_digitNames[8] = QStringLiteral( "arabicEight" );
+
+    s_stateNames[KMinesState::Released].append(QStringLiteral( "cell_up" ));
+    s_stateNames[KMinesState::Pressed].append(QStringLiteral( "cell_down" ));
+    s_stateNames[KMinesState::Revealed].append(QStringLiteral( "cell_down" ));
+    s_stateNames[KMinesState::Questioned].append(QStringLiteral( "cell_up" ));
+    s_stateNames[KMinesState::Questioned].append(QStringLiteral( "question" ));
+    s_stateNames[KMinesState::Flagged].append(QStringLiteral( "cell_up" ));
+    s_stateNames[KMinesState::Flagged].append(QStringLiteral( "flag" ));
+    s_stateNames[KMinesState::Error].append(QStringLiteral( "cell_down" ));
+    s_stateNames[KMinesState::Error].append(QStringLiteral( "mine" ));
+    s_stateNames[KMinesState::Error].append(QStringLiteral( "error" ));
+    s_stateNames[KMinesState::Hint].append(QStringLiteral( "cell_up" ));
+    s_stateNames[KMinesState::Hint].append(QStringLiteral( "hint" ));
+}
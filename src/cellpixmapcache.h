@@ -0,0 +1,123 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef CELLPIXMAPCACHE_H
+#define CELLPIXMAPCACHE_H
+
+// own
+#include "commondefs.h"
+// Qt
+#include <QHash>
+#include <QPixmap>
+#include <QSize>
+#include <QStringList>
+// Std
+#include <functional>
+
+class KGameRenderer;
+class SpriteClient;
+
+/**
+ * Fully composited cell pixmaps: the cell background with all its
+ * overlays (flag, digit, mine, explosion, error mark...) painted into one
+ * pixmap, so that each cell item draws exactly one pixmap.
+ *
+ * Pixmaps are keyed by what the cell displays and are rendered for the
+ * current render size and device pixel ratio. The sprites they are made of are rendered
+ * asynchronously; until all sprites of a pixmap are there, it is made
+ * of the sprites at hand, scaled, or is a plain placeholder. Whenever
+ * sprites change, for a new size or a new theme, the cached pixmaps are
+ * dropped and the callback given to the constructor is called, so that
+ * cells can fetch them again.
+ */
+class CellPixmapCache
+{
+public:
+    CellPixmapCache(KGameRenderer* renderer, const std::function<void()>& onSpritesChanged);
+    ~CellPixmapCache();
+    /**
+     * Number of distinct keys, see key()
+     */
+    static const int KeyCount = 1 << 9;
+    /**
+     * @return key identifying how a cell with given properties looks,
+     * in range [0, KeyCount)
+     */
+    static int key(KMinesState::CellState state, int digit, bool hasMine, bool exploded)
+    {
+        // only Revealed cells show digits and mines
+        if(state != KMinesState::Revealed)
+            return state;
+        return state | (digit << 3) | (hasMine << 7) | (exploded << 8);
+    }
+    /**
+     * @return composited pixmap for a cell with given properties,
+     * at the current render size. Composited on first request, or a
+     * placeholder if the sprites are not rendered yet
+     */
+    QPixmap pixmap(KMinesState::CellState state, int digit, bool hasMine, bool exploded)
+    {
+        return pixmap(key(state, digit, hasMine, exploded));
+    }
+    /**
+     * @return composited pixmap for a key()
+     */
+    QPixmap pixmap(int key);
+    /**
+     * Sets logical size and device pixel ratio of the pixmaps and
+     * requests the sprites for them. Drops all cached pixmaps if they
+     * changed
+     */
+    void setRenderSize(const QSize& size, qreal dpr = 1.0);
+    QSize renderSize() const { return m_size; }
+    qreal devicePixelRatio() const { return m_dpr; }
+    /**
+     * @return size of the pixmaps in device pixels
+     */
+    QSize deviceSize() const { return (QSizeF(m_size) * m_dpr).toSize(); }
+    /**
+     * @return true if all sprites are rendered for the current size
+     */
+    bool isReady() const;
+    /**
+     * Drops all cached pixmaps
+     */
+    void clear();
+private:
+    /**
+     * @return sprite keys to paint on top of each other for a cell
+     */
+    static QStringList spriteKeys(int key);
+    static QHash<int, QString> s_digitNames;
+    static QHash<KMinesState::CellState, QStringList> s_stateNames;
+    static void fillNameHashes();
+    /**
+     * @return plain pixmap shown for key while its sprites are rendered
+     */
+    QPixmap placeholder(int key);
+    /**
+     * @return uninitialized pixmap of deviceSize() for m_dpr
+     */
+    QPixmap createPixmap() const;
+    void onSpriteChanged();
+
+    QSize m_size;
+    qreal m_dpr = 1.0;
+    /**
+     * All sprites cells are made of, by sprite key
+     */
+    QHash<QString, SpriteClient*> m_sprites;
+    std::function<void()> m_onSpritesChanged;
+    QHash<int, QPixmap> m_pixmaps;
+    /**
+     * Pixmaps made while sprites are missing
+     */
+    QHash<int, QPixmap> m_placeholders;
+
+    Q_DISABLE_COPY(CellPixmapCache)
+};
+
+#endif
@@ -0,0 +1,357 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef FIXEDMINEFIELD_H
+#define FIXEDMINEFIELD_H
+
+// Std
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <random>
+
+/**
+ * Mine field with dimensions fixed at compile time, kept as bitboards.
+ *
+ * Cells are numbered like in MineField (row*Cols + col) and stored one bit
+ * per cell in WordCount 64-bit words, so the Expert field (16x30) takes
+ * eight words per board and fits in registers. Neighbourhoods, digits and
+ * flood fill are computed with whole-board shifts, which the compiler
+ * fully unrolls.
+ *
+ * The static kernels work on the same bit layout as MineField's mine
+ * bitset and are used by it for the standard field sizes. The class
+ * itself is a minimal game for solvers and simulations: it knows
+ * revealed and flagged cells, but none of the GUI states.
+ */
+template<int Rows, int Cols>
+class FixedMineField
+{
+public:
+    using Word = std::uint64_t;
+    static constexpr int CellCount = Rows*Cols;
+    static constexpr int WordCount = (CellCount + 63) / 64;
+
+    /**
+     * One bit per cell
+     */
+    struct Board
+    {
+        Word words[WordCount] = {};
+
+        constexpr Word& operator[](int i) { return words[i]; }
+        constexpr Word operator[](int i) const { return words[i]; }
+        Word* data() { return words; }
+        const Word* data() const { return words; }
+        const Word* begin() const { return words; }
+        const Word* end() const { return words + WordCount; }
+
+        constexpr Board operator&(const Board& other) const
+        {
+            Board r;
+            for(int i=0; i<WordCount; ++i)
+                r.words[i] = words[i] & other.words[i];
+            return r;
+        }
+        constexpr Board operator|(const Board& other) const
+        {
+            Board r;
+            for(int i=0; i<WordCount; ++i)
+                r.words[i] = words[i] | other.words[i];
+            return r;
+        }
+        constexpr Board operator^(const Board& other) const
+        {
+            Board r;
+            for(int i=0; i<WordCount; ++i)
+                r.words[i] = words[i] ^ other.words[i];
+            return r;
+        }
+        constexpr Board operator~() const
+        {
+            Board r;
+            for(int i=0; i<WordCount; ++i)
+                r.words[i] = ~words[i];
+            return r;
+        }
+    };
+
+    /**
+     * Places numMines mines, keeping the cell at clickedIdx and its
+     * neighbours free. Same sampling as MineField::generate()
+     */
+    void generate(int clickedIdx, int numMines, std::uint32_t seed)
+    {
+        m_mines = Board{};
+        m_revealed = Board{};
+        m_flagged = Board{};
+        m_lost = false;
+
+        // the clicked cell and its neighbours, in ascending order
+        const Board excludedCells = dilate(single(clickedIdx));
+        int excluded[9];
+        int numExcluded = 0;
+        for(int idx = clickedIdx - Cols - 1; idx <= clickedIdx + Cols + 1; ++idx)
+            if(idx >= 0 && idx < CellCount && test(excludedCells, idx))
+                excluded[numExcluded++] = idx;
+        const int allowedCount = CellCount - numExcluded;
+        numMines = std::max(0, std::min(numMines, allowedCount));
+
+        auto allowedCell = [&excluded, numExcluded](int allowedIdx) {
+            for(int i=0; i<numExcluded && excluded[i] <= allowedIdx; ++i)
+                allowedIdx++;
+            return allowedIdx;
+        };
+
+        std::mt19937 random(seed);
+        for(int j = allowedCount - numMines; j < allowedCount; ++j)
+        {
+            int cell = allowedCell(std::uniform_int_distribution<int>(0, j)(random));
+            if(test(m_mines, cell))
+                cell = allowedCell(j);
+            m_mines[cell >> 6] |= Word(1) << (cell & 63);
+        }
+        m_minesCount = numMines;
+        countNeighbours(m_mines, m_digits);
+        m_empty = ~(m_mines | m_digits[0] | m_digits[1] | m_digits[2] | m_digits[3]) & validMask();
+    }
+    /**
+     * Reveals the cell, and the opening around it if it is empty.
+     * Flagged and revealed cells are left alone.
+     *
+     * @return false if the cell holds a mine
+     */
+    bool open(int idx)
+    {
+        const Board cell = single(idx);
+        if(any(cell & (m_revealed | m_flagged)))
+            return true;
+        return revealCells(cell);
+    }
+    /**
+     * Reveals all unflagged neighbours of a revealed cell,
+     * if it has as many flags around as its digit says.
+     *
+     * @return false if a mine got revealed
+     */
+    bool chord(int idx)
+    {
+        const Board cell = single(idx);
+        if(!any(cell & m_revealed))
+            return true;
+        const Board neighbours = dilate(cell) & ~cell;
+        int numFlags = 0;
+        for(Word w : (neighbours & m_flagged))
+            numFlags += std::popcount(w);
+        if(numFlags == 0 || numFlags != digit(idx))
+            return true;
+        return revealCells(neighbours & ~m_flagged & ~m_revealed);
+    }
+    void toggleFlag(int idx)
+    {
+        if(!test(m_revealed, idx))
+            m_flagged[idx >> 6] ^= Word(1) << (idx & 63);
+    }
+
+    bool hasMine(int idx) const { return test(m_mines, idx); }
+    bool isRevealed(int idx) const { return test(m_revealed, idx); }
+    bool isFlagged(int idx) const { return test(m_flagged, idx); }
+    int digit(int idx) const
+    {
+        return test(m_digits[0], idx) | (test(m_digits[1], idx) << 1)
+             | (test(m_digits[2], idx) << 2) | (test(m_digits[3], idx) << 3);
+    }
+    bool isLost() const { return m_lost; }
+    bool isWon() const
+    {
+        int numRevealed = 0;
+        for(Word w : m_revealed)
+            numRevealed += std::popcount(w);
+        return !m_lost && numRevealed == CellCount - m_minesCount;
+    }
+    const Board& mines() const { return m_mines; }
+    const Board& revealed() const { return m_revealed; }
+
+    /**
+     * Computes digit bitplanes from mines: bit i of plane k is bit k of
+     * the number of mines around cell i, or 0 if cell i holds a mine.
+     *
+     * @param mines WordCount words
+     * @param planes 4*WordCount words, plane after plane
+     */
+    static void countNeighbours(const Word* mines, Word* planes)
+    {
+        Board board;
+        for(int i=0; i<WordCount; ++i)
+            board[i] = mines[i];
+        Board count[4];
+        countNeighbours(board, count);
+        for(int k=0; k<4; ++k)
+            for(int i=0; i<WordCount; ++i)
+                planes[k*WordCount + i] = count[k][i];
+    }
+    static void countNeighbours(const Board& board, Board count[4])
+    {
+        // bit sliced addition of the eight shifted boards
+        const Board east = shiftUp<1>(board) & notFirstColumn();
+        const Board west = shiftDown<1>(board) & notLastColumn();
+        const Board inputs[8] = {
+            east, west,
+            shiftUp<Cols>(board), shiftDown<Cols>(board),
+            shiftUp<Cols>(east), shiftDown<Cols>(east),
+            shiftUp<Cols>(west), shiftDown<Cols>(west)
+        };
+        for(int k=0; k<4; ++k)
+            count[k] = Board{};
+        for(const Board& input : inputs)
+        {
+            Board carry = input;
+            for(int k=0; k<4; ++k)
+            {
+                const Board nextCarry = count[k] & carry;
+                count[k] = count[k] ^ carry;
+                carry = nextCarry;
+            }
+        }
+        for(int k=0; k<4; ++k)
+            count[k] = count[k] & ~board;
+    }
+    /**
+     * Flood fill used to reveal openings: starting from the given empty
+     * cells, repeatedly takes all revealable neighbours and continues
+     * from those which are empty.
+     *
+     * @param seeds, empty, revealable, result WordCount words each
+     * @return cells to reveal in result, seeds themselves not included
+     */
+    static void fill(const Word* seeds, const Word* empty, const Word* revealable, Word* result)
+    {
+        Board front, emptyCells, open, filled;
+        for(int i=0; i<WordCount; ++i)
+        {
+            front[i] = seeds[i];
+            emptyCells[i] = empty[i];
+            open[i] = revealable[i];
+        }
+        while(any(front))
+        {
+            const Board grown = dilate(front) & open & ~filled;
+            filled = filled | grown;
+            front = grown & emptyCells;
+        }
+        for(int i=0; i<WordCount; ++i)
+            result[i] = filled[i];
+    }
+
+private:
+    static constexpr int test(const Board& b, int idx) { return (b[idx >> 6] >> (idx & 63)) & 1; }
+    static constexpr Board single(int idx)
+    {
+        Board b;
+        b[idx >> 6] = Word(1) << (idx & 63);
+        return b;
+    }
+    static constexpr bool any(const Board& b)
+    {
+        Word w = 0;
+        for(int i=0; i<WordCount; ++i)
+            w |= b[i];
+        return w != 0;
+    }
+    static constexpr Board makeMask(int skippedCol)
+    {
+        Board b;
+        for(int idx=0; idx<CellCount; ++idx)
+            if(idx % Cols != skippedCol)
+                b[idx >> 6] |= Word(1) << (idx & 63);
+        return b;
+    }
+    static constexpr Board validMask() { return makeMask(-1); }
+    static constexpr Board notFirstColumn() { return makeMask(0); }
+    static constexpr Board notLastColumn() { return makeMask(Cols-1); }
+
+    /**
+     * Moves cell i to cell i+K
+     */
+    template<int K>
+    static constexpr Board shiftUp(const Board& b)
+    {
+        constexpr int words = K / 64;
+        constexpr int bits = K % 64;
+        Board r;
+        for(int i=WordCount-1; i>=words; --i)
+        {
+            Word w = b[i-words] << bits;
+            if constexpr (bits != 0)
+            {
+                if(i-words-1 >= 0)
+                    w |= b[i-words-1] >> (64-bits);
+            }
+            r[i] = w;
+        }
+        return r & validMask();
+    }
+    /**
+     * Moves cell i to cell i-K
+     */
+    template<int K>
+    static constexpr Board shiftDown(const Board& b)
+    {
+        constexpr int words = K / 64;
+        constexpr int bits = K % 64;
+        Board r;
+        for(int i=0; i+words<WordCount; ++i)
+        {
+            Word w = b[i+words] >> bits;
+            if constexpr (bits != 0)
+            {
+                if(i+words+1 < WordCount)
+                    w |= b[i+words+1] << (64-bits);
+            }
+            r[i] = w;
+        }
+        return r;
+    }
+    /**
+     * Cells of b together with all their neighbours
+     */
+    static constexpr Board dilate(const Board& b)
+    {
+        const Board row = b | (shiftUp<1>(b) & notFirstColumn()) | (shiftDown<1>(b) & notLastColumn());
+        return row | shiftUp<Cols>(row) | shiftDown<Cols>(row);
+    }
+
+    /**
+     * Reveals cells and fills openings from the empty ones among them
+     *
+     * @return false if any of them holds a mine
+     */
+    bool revealCells(const Board& cells)
+    {
+        if(any(cells & m_mines))
+        {
+            m_lost = true;
+            m_revealed = m_revealed | cells;
+            return false;
+        }
+        m_revealed = m_revealed | cells;
+        Board filled;
+        const Board revealable = ~(m_revealed | m_flagged) & validMask();
+        fill((cells & m_empty).data(), m_empty.data(), revealable.data(), filled.data());
+        m_revealed = m_revealed | filled;
+        return true;
+    }
+
+    Board m_mines;
+    Board m_empty;
+    Board m_digits[4];
+    Board m_revealed;
+    Board m_flagged;
+    int m_minesCount = 0;
+    bool m_lost = false;
+};
+
+#endif
@@ -7,6 +7,7 @@
 // own
 #include "kmines_version.h"
 #include "mainwindow.h"
+#include "startupprofile.h"
 // KF
 #include <KAboutData>
 #include <KCrash>
@@ -20,7 +21,9 @@
 
 int main(int argc, char **argv)
 {
+    StartupProfile::start();
     QApplication app(argc, argv);
+    StartupProfile::mark("application created");
 
     KLocalizedString::setApplicationDomain(QByteArrayLiteral("kmines"));
 
@@ -49,15 +52,24 @@ int main(int argc, char **argv)
     KCrash::initialize();
     QCommandLineParser parser;
     aboutData.setupCommandLine(&parser);
+    const QCommandLineOption profileOption(QStringLiteral("startup-profile"),
+                                           i18n("Log the time taken by the steps of startup"));
+    parser.addOption(profileOption);
     parser.process(app);
     aboutData.processCommandLine(&parser);
+    if (parser.isSet(profileOption))
+        StartupProfile::setEnabled(true);
+    StartupProfile::mark("command line processed");
     KDBusService service; 
+    StartupProfile::mark("D-Bus service registered");
     
     if ( app.isSessionRestored() )
         kRestoreMainWindows<KMinesMainWindow>();
     else {
         auto *mw = new KMinesMainWindow;
+        StartupProfile::mark("main window created");
         mw->show();
+        StartupProfile::mark("main window shown");
     }
     
     return app.exec();
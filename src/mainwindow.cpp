@@ -12,6 +12,7 @@
 #include "scene.h"
 #include "settings.h"
 #include "kmines_debug.h"
+#include "startupprofile.h"
 #include "ui_customgame.h"
 #include "ui_generalopts.h"
 // KDEGames
@@ -79,6 +80,7 @@ private:
 KMinesMainWindow::KMinesMainWindow()
 {
     m_scene = new KMinesScene(this);
+    StartupProfile::mark("scene created");
     
     connect(m_scene, &KMinesScene::minesCountChanged, this, &KMinesMainWindow::onMinesCountChanged);
     connect(m_scene, &KMinesScene::gameOver, this, &KMinesMainWindow::onGameOver);
@@ -105,8 +107,10 @@ KMinesMainWindow::KMinesMainWindow()
     statusBar()->insertPermanentWidget( 1, timeLabel );
     setCentralWidget(m_view);
     setupActions();
+    StartupProfile::mark("actions and GUI set up");
 
     newGame();
+    StartupProfile::mark("first game started");
 }
 
 void KMinesMainWindow::setupActions()
@@ -239,11 +243,12 @@ void KMinesMainWindow::configureSettings()
 {
     if ( KConfigDialog::showDialog( QStringLiteral(  "settings" ) ) )
         return;
+    // the theme page lists all themes
+    m_scene->discoverAllThemes();
     auto *dialog = new KConfigDialog( this, QStringLiteral( "settings" ), Settings::self() );
     dialog->addPage( new GeneralOptsConfig( dialog ), i18n("General"), QStringLiteral( "games-config-options" ));
     dialog->addPage( new KGameThemeSelector( m_scene->renderer().themeProvider() ), i18n( "Theme" ), QStringLiteral( "games-config-theme" ));
     dialog->addPage( new CustomGameConfig( dialog ), i18n("Custom Game"), QStringLiteral( "games-config-custom" ));
-    connect( m_scene->renderer().themeProvider(), &KGameThemeProvider::currentThemeChanged, this, &KMinesMainWindow::loadSettings );
     connect(dialog, &KConfigDialog::settingsChanged, this, &KMinesMainWindow::loadSettings);
     
     dialog->show();
@@ -260,6 +265,8 @@ void KMinesMainWindow::pauseGame(bool paused)
 
 void KMinesMainWindow::loadSettings()
 {
+    m_scene->setBatchedRendering(Settings::batchedRendering());
+    m_scene->setSpriteCacheBudget(Settings::spriteCacheBudget());
     m_view->resetCachedContent();
     // trigger complete redraw
     m_scene->resizeScene( (int)m_scene->sceneRect().width(),
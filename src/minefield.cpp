@@ -0,0 +1,730 @@
+/*
+    SPDX-FileCopyrightText: 2007 Dmitry Suzdalev <dimsuz@gmail.com>
+    SPDX-FileCopyrightText: 2010 Brian Croom <brian.s.croom@gmail.com>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "minefield.h"
+
+// own
+#include "fixedminefield.h"
+#include "neighbourcount.h"
+// Std
+#include <algorithm>
+#include <bit>
+#include <random>
+
+/**
+ * Bitboard kernels of FixedMineField for one field size
+ */
+struct MineField::FixedKernels
+{
+    int rows;
+    int cols;
+    void (*countNeighbours)(const Word* mines, Word* planes);
+    void (*fill)(const Word* seeds, const Word* empty, const Word* revealable, Word* result);
+};
+
+template<int Rows, int Cols>
+static constexpr MineField::FixedKernels fixedKernels()
+{
+    static_assert(FixedMineField<Rows, Cols>::WordCount <= MineField::MaxFixedWords);
+    return { Rows, Cols, &FixedMineField<Rows, Cols>::countNeighbours, &FixedMineField<Rows, Cols>::fill };
+}
+
+// standard difficulty levels, see KMinesMainWindow::newGame()
+static const MineField::FixedKernels s_fixedKernels[] = {
+    fixedKernels<9, 9>(),
+    fixedKernels<16, 16>(),
+    fixedKernels<16, 30>(),
+};
+
+MineField::MineField()
+{
+    init(1, 1, 0);
+}
+
+void MineField::init(int numRows, int numCols, int numMines)
+{
+    m_numRows = numRows;
+    m_numCols = numCols;
+    m_minesCount = std::max(0, std::min(numMines, numRows*numCols - MINIMAL_FREE));
+
+    m_fixedKernels = nullptr;
+    for (const FixedKernels& kernels : s_fixedKernels) {
+        if(kernels.rows == numRows && kernels.cols == numCols)
+            m_fixedKernels = &kernels;
+    }
+
+    const int numCells = numRows*numCols;
+    const int numWords = (numCells + 63) / 64;
+    m_mines.assign(numWords, 0);
+    m_digits.assign((numCells + 1) / 2, 0);
+    m_states.assign(numWords * StateBits, 0);
+    m_explodedIdx = -1;
+    m_changedCells.clear();
+    m_changedCells.shrink_to_fit();
+    m_fillStack.clear();
+    m_fillStack.shrink_to_fit();
+    m_openingOf.clear();
+    m_openingStart.clear();
+    m_openingCells.clear();
+    m_openingBlocked.clear();
+    m_openingCount = 0;
+    m_threeBV = 0;
+    m_numUnrevealed = numRows*numCols;
+    m_flaggedCount = 0;
+    m_gameOver = false;
+    m_won = false;
+}
+
+void MineField::reset()
+{
+    // Released is 0 in all bitplanes
+    std::fill(m_states.begin(), m_states.end(), 0);
+    m_explodedIdx = -1;
+    // a board-wide cascade may have left a list as long as the field
+    m_changedCells.clear();
+    m_changedCells.shrink_to_fit();
+    std::fill(m_openingBlocked.begin(), m_openingBlocked.end(), 0);
+    m_numUnrevealed = cellCount();
+    m_flaggedCount = 0;
+    m_gameOver = false;
+    m_won = false;
+}
+
+void MineField::generate(int clickedIdx, std::uint32_t seed)
+{
+    // generating mines ensuring that clickedIdx won't hold mine
+    // and that it will be an empty cell so the user don't have
+    // to make random guesses at the start of the game
+
+    // this is the list of cells we don't want to put the mine in
+    // to ensure that clickedIdx will stay an empty cell
+    // (it will be empty if none of surrounding cells holds mine)
+    int excluded[9];
+    int numExcluded = 0;
+    // neighbours come in ascending order, clickedIdx goes right before the first larger one
+    forEachAdjacentCell(clickedIdx, [&excluded, &numExcluded, clickedIdx](int idx) {
+        if(idx > clickedIdx && (numExcluded == 0 || excluded[numExcluded-1] < clickedIdx))
+            excluded[numExcluded++] = clickedIdx;
+        excluded[numExcluded++] = idx;
+    });
+    if(numExcluded == 0 || excluded[numExcluded-1] < clickedIdx)
+        excluded[numExcluded++] = clickedIdx;
+    const int allowedCount = cellCount() - numExcluded;
+
+    // maps index in the set of allowed cells to cell index
+    auto allowedCell = [&excluded, numExcluded](int allowedIdx) {
+        for(int i=0; i<numExcluded && excluded[i] <= allowedIdx; ++i)
+            allowedIdx++;
+        return allowedIdx;
+    };
+
+    // Floyd's sampling: exactly one random draw per mine, no rejections,
+    // so the cost doesn't depend on density. Each m-subset of the
+    // allowed cells is equally likely
+    std::mt19937 random(seed);
+    for(int j = allowedCount - m_minesCount; j < allowedCount; ++j)
+    {
+        int cell = allowedCell(std::uniform_int_distribution<int>(0, j)(random));
+        if(hasMine(cell))
+            cell = allowedCell(j);
+        // ok, let's mine this place! :-)
+        setMine(cell);
+    }
+
+    computeDigits();
+    buildOpeningIndex();
+}
+
+void MineField::computeDigits()
+{
+    if(m_fixedKernels)
+    {
+        computeFixedDigits();
+        return;
+    }
+
+    // mine flags of three rows at a time, one byte per cell and
+    // padded with a zero byte on each side, see countNeighbourMines()
+    const int stride = m_numCols + 2;
+    std::vector<std::uint8_t> buffer(4*stride + m_numCols, 0);
+    const std::uint8_t* noRow = buffer.data();
+    std::uint8_t* above = buffer.data() + stride;
+    std::uint8_t* row = above + stride;
+    std::uint8_t* below = row + stride;
+    std::uint8_t* digits = below + stride;
+
+    auto expandRow = [this](int rowIdx, std::uint8_t* dest) {
+        const int start = index(rowIdx, 0);
+        for(int col=0; col<m_numCols; ++col)
+            dest[col+1] = hasMine(start + col);
+    };
+
+    expandRow(0, row);
+    for(int rowIdx=0; rowIdx<m_numRows; ++rowIdx)
+    {
+        if(rowIdx+1 < m_numRows)
+            expandRow(rowIdx+1, below);
+        KMinesKernels::countNeighbourMines(rowIdx > 0 ? above : noRow, row,
+                                           rowIdx+1 < m_numRows ? below : noRow,
+                                           digits, m_numCols);
+
+        const int start = index(rowIdx, 0);
+        for(int col=0; col<m_numCols; ++col)
+            setDigit(start + col, digits[col]);
+
+        std::swap(above, row);
+        std::swap(row, below);
+    }
+}
+
+void MineField::computeFixedDigits()
+{
+    const int numWords = static_cast<int>(m_mines.size());
+    Word planes[4 * MaxFixedWords];
+    m_fixedKernels->countNeighbours(m_mines.data(), planes);
+
+    for(int idx=0; idx<cellCount(); ++idx)
+    {
+        const int word = idx >> 6;
+        const int bit = idx & 63;
+        int digit = 0;
+        for(int k=0; k<4; ++k)
+            digit |= ((planes[k*numWords + word] >> bit) & 1) << k;
+        setDigit(idx, digit);
+    }
+
+    m_emptyCells.resize(numWords);
+    for(int i=0; i<numWords; ++i)
+        m_emptyCells[i] = ~(m_mines[i] | planes[i] | planes[numWords + i]
+                            | planes[2*numWords + i] | planes[3*numWords + i]);
+}
+
+void MineField::buildOpeningIndex()
+{
+    // Single pass union-find over empty cells (8-connected):
+    // each empty cell is joined with the already visited empty
+    // neighbours (W, NW, N, NE), then labels get compacted.
+    const int numCells = cellCount();
+    std::vector<OpeningCell>& parent = m_openingOf;
+    parent.assign(numCells, NoOpening);
+
+    auto findRoot = [&parent](OpeningCell idx) {
+        while(parent[idx] != idx)
+        {
+            parent[idx] = parent[parent[idx]]; // path halving
+            idx = parent[idx];
+        }
+        return idx;
+    };
+    auto unite = [&parent, &findRoot](OpeningCell a, OpeningCell b) {
+        a = findRoot(a);
+        b = findRoot(b);
+        if(a < b)
+            parent[b] = a;
+        else if(b < a)
+            parent[a] = b;
+    };
+
+    for(int row=0; row<m_numRows; ++row)
+        for(int col=0; col<m_numCols; ++col)
+        {
+            const int idx = index(row,col);
+            if(!isEmptyCell(idx))
+                continue;
+            parent[idx] = idx;
+            if(col > 0 && isEmptyCell(idx-1))
+                unite(idx, idx-1);
+            if(row > 0)
+            {
+                for(int up = std::max(col-1, 0); up <= std::min(col+1, m_numCols-1); ++up)
+                    if(isEmptyCell(index(row-1, up)))
+                        unite(idx, index(row-1, up));
+            }
+        }
+
+    // parents always precede their children, so in one forward pass
+    // the parent of a cell already holds the compact label of their root
+    int numOpenings = 0;
+    for(int idx=0; idx<numCells; ++idx)
+    {
+        if(parent[idx] == NoOpening)
+            continue;
+        parent[idx] = (parent[idx] == OpeningCell(idx)) ? numOpenings++ : parent[parent[idx]];
+    }
+
+    m_openingCount = numOpenings;
+    m_threeBV = numOpenings;
+
+    // Collect opening members (empty cells and their bordering digits)
+    // into compressed rows: cells of opening i are
+    // m_openingCells[m_openingStart[i] .. m_openingStart[i+1])
+    m_openingStart.assign(numOpenings + 1, 0);
+    OpeningCell labels[8];
+    auto borderedOpenings = [this, &labels](int idx) {
+        int numLabels = 0;
+        forEachAdjacentCell(idx, [this, &labels, &numLabels](int neighbour) {
+            const OpeningCell label = m_openingOf[neighbour];
+            if(label != NoOpening && std::find(labels, labels + numLabels, label) == labels + numLabels)
+                labels[numLabels++] = label;
+        });
+        return numLabels;
+    };
+    for(int idx=0; idx<numCells; ++idx)
+    {
+        if(m_openingOf[idx] != NoOpening)
+        {
+            m_openingStart[m_openingOf[idx] + 1]++;
+        }
+        else if(!hasMine(idx))
+        {
+            const int numLabels = borderedOpenings(idx);
+            for(int i=0; i<numLabels; ++i)
+                m_openingStart[labels[i] + 1]++;
+            // a digit cell not bordering any opening needs a click of its own
+            if(numLabels == 0)
+                m_threeBV++;
+        }
+    }
+    for(int i=0; i<numOpenings; ++i)
+        m_openingStart[i+1] += m_openingStart[i];
+
+    m_openingCells.resize(m_openingStart[numOpenings]);
+    std::vector<int> fillPos(m_openingStart.begin(), m_openingStart.end() - 1);
+    for(int idx=0; idx<numCells; ++idx)
+    {
+        if(m_openingOf[idx] != NoOpening)
+        {
+            m_openingCells[fillPos[m_openingOf[idx]]++] = idx;
+        }
+        else if(!hasMine(idx))
+        {
+            const int numLabels = borderedOpenings(idx);
+            for(int i=0; i<numLabels; ++i)
+                m_openingCells[fillPos[labels[i]]++] = idx;
+        }
+    }
+
+    // cells might have been marked or pressed before the first click
+    m_openingBlocked.assign(numOpenings, 0);
+    for(int idx=0; idx<numCells; ++idx)
+    {
+        if(m_openingOf[idx] != NoOpening && !isRevealable(idx))
+            m_openingBlocked[m_openingOf[idx]]++;
+    }
+}
+
+void MineField::setTrackChanges(bool track)
+{
+    m_trackChanges = track;
+    if(!track)
+    {
+        m_changedCells.clear();
+        m_changedCells.shrink_to_fit();
+    }
+}
+
+std::size_t MineField::memoryUsage() const
+{
+    return m_mines.capacity() * sizeof(Word)
+         + m_digits.capacity() * sizeof(std::uint8_t)
+         + m_states.capacity() * sizeof(Word)
+         + (m_changedCells.capacity() + m_fillStack.capacity()) * sizeof(int);
+}
+
+std::size_t MineField::openingIndexMemoryUsage() const
+{
+    return (m_openingOf.capacity() + m_openingCells.capacity()) * sizeof(OpeningCell)
+         + (m_openingStart.capacity() + m_openingBlocked.capacity()) * sizeof(int);
+}
+
+void MineField::setState(int idx, KMinesState::CellState state)
+{
+    const KMinesState::CellState oldState = this->state(idx);
+    if(state == oldState)
+        return;
+    if(m_trackChanges)
+        m_changedCells.push_back(idx);
+
+    if(!m_openingOf.empty() && m_openingOf[idx] != NoOpening)
+    {
+        const bool wasRevealable = isRevealableState(oldState);
+        if(wasRevealable != isRevealableState(state))
+            m_openingBlocked[m_openingOf[idx]] += wasRevealable ? 1 : -1;
+    }
+
+    Word* planes = &m_states[(idx >> 6) * StateBits];
+    const Word mask = Word(1) << (idx & 63);
+    for(int i=0; i<StateBits; ++i)
+    {
+        if(state & (1 << i))
+            planes[i] |= mask;
+        else
+            planes[i] &= ~mask;
+    }
+}
+
+void MineField::setDigit(int idx, int digit)
+{
+    std::uint8_t& pair = m_digits[idx >> 1];
+    const int shift = (idx & 1) * 4;
+    pair = (pair & ~(0xF << shift)) | (digit << shift);
+}
+
+bool MineField::isRevealed(int idx) const
+{
+    const KMinesState::CellState s = state(idx);
+    return s == KMinesState::Revealed || s == KMinesState::Error;
+}
+
+bool MineField::isFlagged(int idx) const
+{
+    return state(idx) == KMinesState::Flagged;
+}
+
+bool MineField::isQuestioned(int idx) const
+{
+    return state(idx) == KMinesState::Questioned;
+}
+
+void MineField::press(int idx)
+{
+    if(state(idx) == KMinesState::Released)
+        setState(idx, KMinesState::Pressed);
+}
+
+void MineField::undoPress(int idx)
+{
+    if(state(idx) == KMinesState::Pressed)
+        setState(idx, KMinesState::Released);
+}
+
+bool MineField::mark(int idx, bool useQuestionMarks)
+{
+    // this will provide cycling through
+    // Released -> "?"-mark -> "RedFlag"-mark -> Released
+    const KMinesState::CellState oldState = state(idx);
+    KMinesState::CellState newState = oldState;
+
+    switch(oldState)
+    {
+        case KMinesState::Released:
+            newState = KMinesState::Flagged;
+            break;
+        case KMinesState::Flagged:
+            newState = useQuestionMarks ? KMinesState::Questioned : KMinesState::Released;
+            break;
+        case KMinesState::Questioned:
+            newState = KMinesState::Released;
+            break;
+        default:
+            // shouldn't be here
+            break;
+    } // end switch
+    setState(idx, newState);
+
+    const bool wasFlagged = (oldState == KMinesState::Flagged);
+    const bool isFlaggedNow = (newState == KMinesState::Flagged);
+    if(isFlaggedNow == wasFlagged)
+        return false;
+    m_flaggedCount += isFlaggedNow ? 1 : -1;
+    return true;
+}
+
+bool MineField::open(int idx)
+{
+    if(m_gameOver || state(idx) != KMinesState::Pressed)
+        return m_gameOver;
+
+    return revealCells(&idx, 1);
+}
+
+bool MineField::chord(int idx)
+{
+    if(m_gameOver)
+        return true;
+
+    const Neighbours neighbours = adjacentCells(idx);
+    if(!isRevealed(idx))
+    {
+        for (int neighbour : neighbours) {
+            undoPress(neighbour);
+        }
+        return false;
+    }
+
+    int numFlags = 0;
+    int numMines = 0;
+    for (int neighbour : neighbours) {
+        if(isFlagged(neighbour))
+            numFlags++;
+        if(hasMine(neighbour))
+            numMines++;
+    }
+    if(numFlags == numMines && numFlags != 0)
+        return revealCells(neighbours.begin(), neighbours.size());
+    else
+    {
+        for (int neighbour : neighbours) {
+            undoPress(neighbour);
+        }
+    }
+    return false;
+}
+
+void MineField::reveal(int idx)
+{
+    if(isRevealed(idx))
+        return; // already revealed
+
+    if(isFlagged(idx) && !hasMine(idx))
+        setState(idx, KMinesState::Error);
+    else
+        setState(idx, KMinesState::Revealed);
+}
+
+bool MineField::revealCells(const int* cells, int numCells)
+{
+    // Reveal the cells one by one, expanding empty ones, and stop at the
+    // first mine or once the field is cleared, like a player would.
+    // The game rules are applied once for the whole batch afterwards
+    for(int i=0; i<numCells && m_explodedIdx == -1 && m_numUnrevealed != m_minesCount; ++i)
+    {
+        const int idx = cells[i];
+        // revealing only unrevealed and unmarked ones
+        if(!isRevealable(idx))
+            continue;
+
+        // if we hold mine, let's explode
+        if(hasMine(idx))
+            m_explodedIdx = idx;
+        reveal(idx);
+        m_numUnrevealed--;
+
+        if(isEmptyCell(idx))
+        {
+            if(!revealOpening(idx))
+                revealEmptySpace(idx);
+        }
+    }
+
+    if(m_explodedIdx != -1)
+        revealAllMines();
+    // now let's check for possible win/loss
+    if(checkLost())
+        return true;
+    return checkWon();
+}
+
+bool MineField::isRevealableState(KMinesState::CellState state)
+{
+    return state != KMinesState::Revealed && state != KMinesState::Error
+        && state != KMinesState::Flagged && state != KMinesState::Questioned;
+}
+
+bool MineField::isRevealable(int idx) const
+{
+    return isRevealableState(state(idx));
+}
+
+bool MineField::isEmptyCell(int idx) const
+{
+    return !hasMine(idx) && digit(idx) == 0;
+}
+
+void MineField::revealFixedEmptySpace(int idx)
+{
+    const int numWords = static_cast<int>(m_mines.size());
+    Word seeds[MaxFixedWords] = {};
+    Word revealable[MaxFixedWords] = {};
+    Word filled[MaxFixedWords] = {};
+    seeds[idx >> 6] = Word(1) << (idx & 63);
+    for(int i=0; i<numWords; ++i)
+    {
+        // Released, Pressed and Hint, see KMinesState::CellState
+        const Word* planes = &m_states[i * StateBits];
+        revealable[i] = (~planes[2] & ~planes[1]) | (planes[2] & planes[1] & ~planes[0]);
+    }
+    m_fixedKernels->fill(seeds, m_emptyCells.data(), revealable, filled);
+
+    for(int i=0; i<numWords; ++i)
+    {
+        for(Word w = filled[i]; w != 0; w &= w - 1)
+        {
+            reveal(i*64 + std::countr_zero(w));
+            m_numUnrevealed--;
+        }
+    }
+}
+
+bool MineField::revealOpening(int idx)
+{
+    // The opening can be revealed as a whole only if the fill would
+    // reach all of it, i.e. none of its empty cells is marked
+    // or revealed except the one which was just clicked
+    if(m_openingOf.empty())
+        return false;
+    const int opening = m_openingOf[idx];
+    if(m_openingBlocked[opening] != 1)
+        return false;
+
+    const int end = m_openingStart[opening + 1];
+    for(int i = m_openingStart[opening]; i < end; ++i)
+    {
+        const int cell = m_openingCells[i];
+        if(isRevealable(cell))
+        {
+            reveal(cell);
+            m_numUnrevealed--;
+        }
+    }
+    return true;
+}
+
+void MineField::revealEmptySpace(int idx)
+{
+    if(m_fixedKernels)
+    {
+        revealFixedEmptySpace(idx);
+        return;
+    }
+
+    // Span based flood fill with an explicit stack: takes a run of
+    // empty cells in a row at once, reveals it together with its
+    // bordering cells and pushes one seed per run of empty cells
+    // found in the rows above and below.
+    // Cells next to an empty one never hold mines, so a zero digit
+    // below always means an empty cell.
+    m_fillStack.clear();
+    m_fillStack.push_back(idx);
+
+    while(!m_fillStack.empty())
+    {
+        const int seed = m_fillStack.back();
+        m_fillStack.pop_back();
+
+        // the cell clicked by the player is already revealed,
+        // other seeds might have been revealed by another run meanwhile
+        if(seed != idx)
+        {
+            if(!isRevealable(seed))
+                continue;
+            reveal(seed);
+            m_numUnrevealed--;
+        }
+
+        const int row = seed / m_numCols;
+        const int rowStart = row*m_numCols;
+        int left = seed - rowStart;
+        int right = left;
+
+        while(left > 0 && isRevealable(rowStart + left - 1))
+        {
+            --left;
+            reveal(rowStart + left);
+            m_numUnrevealed--;
+            if(digit(rowStart + left) != 0)
+                break;
+        }
+        while(right < m_numCols-1 && isRevealable(rowStart + right + 1))
+        {
+            ++right;
+            reveal(rowStart + right);
+            m_numUnrevealed--;
+            if(digit(rowStart + right) != 0)
+                break;
+        }
+        // the loops above might have stopped at a digit, which ends the run
+        const int runLeft = (digit(rowStart + left) != 0) ? left + 1 : left;
+        const int runRight = (digit(rowStart + right) != 0) ? right - 1 : right;
+
+        const int scanLeft = std::max(runLeft - 1, 0);
+        const int scanRight = std::min(runRight + 1, m_numCols - 1);
+        for(int adjacentRow = row - 1; adjacentRow <= row + 1; adjacentRow += 2)
+        {
+            if(adjacentRow < 0 || adjacentRow >= m_numRows)
+                continue;
+
+            bool inRun = false;
+            for(int col = scanLeft; col <= scanRight; ++col)
+            {
+                const int cell = adjacentRow*m_numCols + col;
+                if(isRevealable(cell))
+                {
+                    if(digit(cell) == 0)
+                    {
+                        if(!inRun)
+                            m_fillStack.push_back(cell);
+                        inRun = true;
+                        continue;
+                    }
+                    reveal(cell);
+                    m_numUnrevealed--;
+                }
+                inRun = false;
+            }
+        }
+    }
+}
+
+void MineField::revealAllMines()
+{
+    // one pass over the words for mines neither flagged nor revealed
+    // and for wrongly placed flags. In the bitplanes Flagged is 100,
+    // Revealed 010 and Error 101
+    const int numWords = static_cast<int>(m_mines.size());
+    for(int i=0; i<numWords; ++i)
+    {
+        const Word* planes = &m_states[i * StateBits];
+        const Word flagged = planes[2] & ~planes[1] & ~planes[0];
+        const Word revealed = (~planes[2] & planes[1] & ~planes[0]) | (planes[2] & ~planes[1] & planes[0]);
+        for(Word w = (m_mines[i] & ~flagged & ~revealed) | (flagged & ~m_mines[i]); w != 0; w &= w - 1)
+        {
+            reveal(i*64 + std::countr_zero(w));
+            m_numUnrevealed--;
+        }
+    }
+}
+
+bool MineField::checkLost()
+{
+    // for loss...
+    if(m_explodedIdx != -1)
+    {
+        m_gameOver = true;
+        m_won = false;
+        return true;
+    }
+    return false;
+}
+
+bool MineField::checkWon()
+{
+    // this also takes into account the trivial case when
+    // only some cells left unflagged and they
+    // all contain bombs. this counts as win
+    if(m_numUnrevealed == m_minesCount)
+    {
+        // mark not flagged cells (if any) with flags.
+        // All cells left unrevealed hold mines now
+        const int numWords = static_cast<int>(m_mines.size());
+        for(int i=0; i<numWords; ++i)
+        {
+            for(Word w = m_mines[i]; w != 0; w &= w - 1)
+            {
+                const int idx = i*64 + std::countr_zero(w);
+                if( isQuestioned(idx) )
+                    mark(idx, true);
+                if( !isRevealed(idx) && !isFlagged(idx) )
+                    mark(idx, true);
+            }
+        }
+        m_gameOver = true;
+        m_won = true;
+        return true;
+    }
+    return false;
+}
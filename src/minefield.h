@@ -0,0 +1,402 @@
+/*
+    SPDX-FileCopyrightText: 2007 Dmitry Suzdalev <dimsuz@gmail.com>
+    SPDX-FileCopyrightText: 2010 Brian Croom <brian.s.croom@gmail.com>
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef MINEFIELD_H
+#define MINEFIELD_H
+
+// own
+#include "commondefs.h"
+// Std
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * Logical model of the mine field.
+ * Holds mines, digits and cell states together with the game rules
+ * (field generation, revealing, chording, win/loss detection).
+ *
+ * This class doesn't depend on Qt graphics or KDEGames, so it can be used
+ * headless, e.g. for batch simulations. MineFieldItem is a view over it.
+ *
+ * Cells are addressed by index, which is row*columnCount() + col.
+ *
+ * Cell data is kept as a structure of bit-packed arrays, costing
+ * one byte per cell: a mine bitset, 4-bit digits and the 3-bit
+ * KMinesState::CellState stored as three bitplanes.
+ *
+ * generate() also builds an opening index of 32-bit labels and cell
+ * indices, which is kept apart from the cell data, see
+ * openingIndexMemoryUsage().
+ */
+class MineField
+{
+public:
+    /**
+     * Constructs an empty 1x1 field without mines
+     */
+    MineField();
+    /**
+     * Initializes the field: (re)creates cells and resets all counters.
+     * Mines are placed later with generate()
+     *
+     * @param numRows number of rows
+     * @param numCols number of columns
+     * @param numMines number of mines. Clamped to leave at least MINIMAL_FREE cells free
+     */
+    void init(int numRows, int numCols, int numMines);
+    /**
+     * Resets the field to the unrevealed state, keeping the mines
+     * at their places
+     */
+    void reset();
+    /**
+     * Places mines ensuring that cell at clickedIdx
+     * will be empty to allow the player quickly jump into the game.
+     *
+     * @param clickedIdx specifies index which should NOT have mine and be empty
+     * @param seed seed for the random generator
+     */
+    void generate(int clickedIdx, std::uint32_t seed);
+    /**
+     * @return num rows in field
+     */
+    int rowCount() const { return m_numRows; }
+    /**
+     * @return num columns in field
+     */
+    int columnCount() const { return m_numCols; }
+    /**
+     * @return num mines in field
+     */
+    int minesCount() const { return m_minesCount; }
+    /**
+     * @return number of flagged cells
+     */
+    int flaggedCount() const { return m_flaggedCount; }
+    /**
+     * @return number of cells which are not revealed yet
+     */
+    int unrevealedCount() const { return m_numUnrevealed; }
+    /**
+     * @return total number of cells
+     */
+    int cellCount() const { return m_numRows*m_numCols; }
+    /**
+     * @return index of the cell at (row,col)
+     */
+    int index(int row, int col) const { return row*m_numCols + col; }
+
+    KMinesState::CellState state(int idx) const
+    {
+        const Word* planes = &m_states[(idx >> 6) * StateBits];
+        const int bit = idx & 63;
+        return static_cast<KMinesState::CellState>(((planes[0] >> bit) & 1)
+                                                   | (((planes[1] >> bit) & 1) << 1)
+                                                   | (((planes[2] >> bit) & 1) << 2));
+    }
+    bool hasMine(int idx) const { return (m_mines[idx >> 6] >> (idx & 63)) & 1; }
+    /**
+     * @return digit the cell holds or 0 if none
+     */
+    int digit(int idx) const { return (m_digits[idx >> 1] >> ((idx & 1) * 4)) & 0xF; }
+    bool isExploded(int idx) const { return idx == m_explodedIdx; }
+    bool isRevealed(int idx) const;
+    bool isFlagged(int idx) const;
+    bool isQuestioned(int idx) const;
+    /**
+     * @return number of bytes allocated for cell storage, changedCells()
+     * and the span fill's seeds. See also openingIndexMemoryUsage()
+     */
+    std::size_t memoryUsage() const;
+    /**
+     * @return number of bytes allocated for the opening index,
+     * which is built by generate()
+     */
+    std::size_t openingIndexMemoryUsage() const;
+    /**
+     * @return number of openings (connected areas of empty cells).
+     * Valid after generate()
+     */
+    int openingCount() const { return m_openingCount; }
+    /**
+     * @return 3BV of the field: the minimal number of clicks
+     * needed to reveal it without chording. Valid after generate()
+     */
+    int threeBV() const { return m_threeBV; }
+
+    /**
+     * Visually presses the cell if it is released
+     */
+    void press(int idx);
+    /**
+     * Releases the cell if it is pressed
+     */
+    void undoPress(int idx);
+    /**
+     * Cycles cell marks: Released -> Flagged -> Questioned -> Released.
+     * The Questioned step is skipped if useQuestionMarks is false.
+     *
+     * @return whether the flagged state of the cell changed
+     */
+    bool mark(int idx, bool useQuestionMarks);
+    /**
+     * Reveals a pressed cell (left button release) and applies game rules.
+     *
+     * @return true if the game is finished after the call
+     */
+    bool open(int idx);
+    /**
+     * Mid-button magic: if the number of flags around the revealed cell idx
+     * equals the number of mines around it, reveals all other neighbours.
+     * Otherwise unpresses them.
+     *
+     * @return true if the game is finished after the call
+     */
+    bool chord(int idx);
+    /**
+     * @return true if the game is finished (either won or lost)
+     */
+    bool isGameOver() const { return m_gameOver; }
+    /**
+     * @return true if the game is finished and won
+     */
+    bool isWon() const { return m_won; }
+    /**
+     * Indices of cells whose state changed since the last call
+     * to clearChangedCells(). May contain duplicates.
+     * Only recorded after setTrackChanges(true). Cells are not recorded
+     * by init() and reset(), which change all of them and release the
+     * list's memory
+     */
+    const std::vector<int>& changedCells() const { return m_changedCells; }
+    void clearChangedCells() { m_changedCells.clear(); }
+    /**
+     * Enables recording changedCells(), off by default so that headless
+     * users don't have to clear them
+     */
+    void setTrackChanges(bool track);
+    /**
+     * Fixed-capacity list of the (up to 8) neighbours of a cell,
+     * ordered by index. Lives on the stack, so iterating neighbours
+     * never allocates
+     */
+    class Neighbours
+    {
+    public:
+        const int* begin() const { return m_cells; }
+        const int* end() const { return m_cells + m_count; }
+        int size() const { return m_count; }
+    private:
+        friend class MineField;
+        int m_cells[8];
+        int m_count = 0;
+    };
+    /**
+     * Returns indices of all valid adjacent cells of cell idx
+     */
+    Neighbours adjacentCells(int idx) const
+    {
+        Neighbours result;
+        forEachAdjacentCell(idx, [&result](int neighbour) {
+            result.m_cells[result.m_count++] = neighbour;
+        });
+        return result;
+    }
+    /**
+     * Calls visit(neighbour) for all valid adjacent cells of cell idx,
+     * in ascending index order
+     */
+    template<typename Visitor>
+    void forEachAdjacentCell(int idx, Visitor visit) const
+    {
+        const int row = idx / m_numCols;
+        const int col = idx - row*m_numCols;
+        const int edges = (row == 0 ? TopEdge : 0) | (row == m_numRows-1 ? BottomEdge : 0)
+                        | (col == 0 ? LeftEdge : 0) | (col == m_numCols-1 ? RightEdge : 0);
+        for (const NeighbourOffset& offset : s_neighbourOffsets) {
+            if((edges & offset.edges) == 0)
+                visit(idx + offset.rows*m_numCols + offset.cols);
+        }
+    }
+
+    /**
+     * Minimal number of free positions on a field
+     */
+    static const int MINIMAL_FREE = 10;
+
+    using Word = std::uint64_t;
+    struct FixedKernels;
+    /**
+     * Largest number of words in a bitboard of the field sizes
+     * having FixedMineField kernels
+     */
+    static const int MaxFixedWords = 8;
+    /**
+     * Cell indices and labels in the opening index
+     */
+    using OpeningCell = std::uint32_t;
+
+private:
+    /**
+     * Number of bitplanes holding KMinesState::CellState
+     */
+    static const int StateBits = 3;
+    static constexpr OpeningCell NoOpening = 0xFFFFFFFF;
+
+    enum Edge { TopEdge = 1, BottomEdge = 2, LeftEdge = 4, RightEdge = 8 };
+    /**
+     * Position of a neighbour relative to the cell, and the field
+     * edges which the cell must not touch for the neighbour to exist
+     */
+    struct NeighbourOffset
+    {
+        int rows;
+        int cols;
+        int edges;
+    };
+    static constexpr NeighbourOffset s_neighbourOffsets[8] = {
+        { -1, -1, TopEdge | LeftEdge },    // upper-left diagonal
+        { -1,  0, TopEdge },               // upper
+        { -1,  1, TopEdge | RightEdge },   // upper-right diagonal
+        {  0, -1, LeftEdge },              // on the left
+        {  0,  1, RightEdge },             // on the right
+        {  1, -1, BottomEdge | LeftEdge }, // bottom-left diagonal
+        {  1,  0, BottomEdge },            // bottom
+        {  1,  1, BottomEdge | RightEdge } // bottom-right diagonal
+    };
+
+    void setState(int idx, KMinesState::CellState state);
+    void setMine(int idx) { m_mines[idx >> 6] |= Word(1) << (idx & 63); }
+    void setDigit(int idx, int digit);
+    /**
+     * Sets digits of all cells from the mine bitset in one pass
+     */
+    void computeDigits();
+    /**
+     * computeDigits() for field sizes having FixedMineField kernels
+     */
+    void computeFixedDigits();
+    /**
+     * revealEmptySpace() for field sizes having FixedMineField kernels
+     */
+    void revealFixedEmptySpace(int idx);
+    /**
+     * Labels openings and collects their cells, see m_openingOf.
+     * Also counts the openings and the 3BV
+     */
+    void buildOpeningIndex();
+    /**
+     * Reveals the whole opening containing the just revealed empty cell idx
+     * if nothing inside it would stop revealEmptySpace().
+     *
+     * @return false if it wasn't possible and revealEmptySpace() has to be used
+     */
+    bool revealOpening(int idx);
+    /**
+     * Reveals the cell: Revealed, or Error for a wrongly flagged one
+     */
+    void reveal(int idx);
+    /**
+     * @return whether the cell is neither revealed nor marked
+     */
+    bool isRevealable(int idx) const;
+    static bool isRevealableState(KMinesState::CellState state);
+    /**
+     * @return whether the cell holds neither a mine nor a digit
+     */
+    bool isEmptyCell(int idx) const;
+    /**
+     * Reveal transaction: reveals the unrevealed and unmarked cells among
+     * the given ones together with the openings they start, exploding the
+     * first mine hit. Win and loss are evaluated once, after all cells.
+     *
+     * @return true if the game is finished after the call
+     */
+    bool revealCells(const int* cells, int numCells);
+    /**
+     * Reveals all empty cells around cell idx,
+     * until it found cells with digits (which are also revealed)
+     */
+    void revealEmptySpace(int idx);
+    /**
+     * Reveals all unmarked cells containing mines and all wrong flags,
+     * in one pass over the mine and state words
+     */
+    void revealAllMines();
+    /**
+     * Checks if player lost the game. Return `true` if lost.
+     * Constant time: there is only one exploded cell to look at
+     */
+    bool checkLost();
+    /**
+     * Checks if player won the game. Return `true` if won.
+     * Flags all remaining cells on win.
+     */
+    bool checkWon();
+
+    /**
+     * One bit per cell, set if the cell holds a mine
+     */
+    std::vector<Word> m_mines;
+    /**
+     * Two cells per byte, low nibble holds the even cell
+     */
+    std::vector<std::uint8_t> m_digits;
+    /**
+     * StateBits words per 64 cells, one per bit of the cell state
+     */
+    std::vector<Word> m_states;
+    /**
+     * Index of the exploded cell, -1 if none.
+     * The game ends on the first explosion, so there is at most one
+     */
+    int m_explodedIdx = -1;
+    /**
+     * Bitboard kernels for this field size, nullptr if there are none
+     */
+    const FixedKernels* m_fixedKernels = nullptr;
+    /**
+     * Bitset of cells holding neither mine nor digit, used with m_fixedKernels
+     */
+    std::vector<Word> m_emptyCells;
+    /**
+     * See changedCells()
+     */
+    std::vector<int> m_changedCells;
+    bool m_trackChanges = false;
+    /**
+     * Opening index: label of the opening for each empty cell,
+     * NoOpening for other cells. Empty until generate()
+     */
+    std::vector<OpeningCell> m_openingOf;
+    /**
+     * Cells of opening i (empty ones and the digits bordering them) are
+     * m_openingCells[m_openingStart[i] .. m_openingStart[i+1])
+     */
+    std::vector<int> m_openingStart;
+    std::vector<OpeningCell> m_openingCells;
+    /**
+     * Number of empty cells per opening which are revealed or marked
+     */
+    std::vector<int> m_openingBlocked;
+    int m_openingCount = 0;
+    int m_threeBV = 0;
+    /**
+     * Seeds of revealEmptySpace(), kept to reuse the allocation
+     */
+    std::vector<int> m_fillStack;
+    int m_numRows = 1;
+    int m_numCols = 1;
+    int m_minesCount = 0;
+    int m_flaggedCount = 0;
+    int m_numUnrevealed = 1;
+    bool m_gameOver = false;
+    bool m_won = false;
+};
+
+#endif
@@ -11,203 +11,117 @@
 #include "kmines_debug.h"
 #include "cellitem.h"
 #include "borderitem.h"
+#include "minimapitem.h"
 #include "settings.h"
+// KDEGames
+#include <KGameRenderer>
 // Qt
 #include <QGraphicsScene>
 #include <QGraphicsSceneMouseEvent>
+#include <QGraphicsSceneWheelEvent>
 #include <QRandomGenerator>
+#include <QStyleOptionGraphicsItem>
 
 MineFieldItem::MineFieldItem(KGameRenderer* renderer)
-    : m_leftButtonPos(-1,-1), m_midButtonPos(-1,-1), m_gameOver(false),
+    : m_pixmapCache(renderer, [this] {
+          // sprites tend to arrive in bursts, refetch once for all of them
+          if(!m_spritesChangedPending)
+          {
+              m_spritesChangedPending = true;
+              QMetaObject::invokeMethod(this, &MineFieldItem::onSpritesChanged, Qt::QueuedConnection);
+          }
+      }),
+      m_leftButtonPos(-1,-1), m_midButtonPos(-1,-1), m_gameOver(false),
       m_emulatingMidButton(false), m_renderer(renderer)
 {
 	setFlag(QGraphicsItem::ItemHasNoContents);
+	// cells and borders scrolled partially out of the view are cut off
+	setFlag(QGraphicsItem::ItemClipsToShape);
+	setFlag(QGraphicsItem::ItemClipsChildrenToShape);
+	m_fragments.resize(CellPixmapCache::KeyCount);
+	// the items follow the field through its changed cells
+	m_field.setTrackChanges(true);
+
+	m_border = new BorderItem(m_renderer, this);
+
+	m_miniMap = new MiniMapItem(this);
+	m_miniMap->setZValue(1);
+	m_miniMap->hide();
+	connect(m_miniMap, &MiniMapItem::clicked, this, &MineFieldItem::centerOn);
 }
 
 void MineFieldItem::resetMines()
 {
     m_gameOver = false;
-    m_numUnrevealed = m_numRows*m_numCols;
-
-    for(CellItem* item : std::as_const(m_cells)) {
-        item->unreveal();
-        item->unflag();
-        item->unexplode();
-    }
-
-    m_flaggedMinesCount = 0;
-    Q_EMIT flaggedMinesCountChanged(m_flaggedMinesCount);
+    m_field.reset();
+    m_miniMap->init(m_numRows, m_numCols);
+    updateAllItems();
+
+    m_reportedFlaggedCount = m_field.flaggedCount();
+    Q_EMIT flaggedMinesCountChanged(m_reportedFlaggedCount);
+    m_createdItemsAtStart = CellItem::createdItemCount();
+    m_destroyedItemsAtStart = CellItem::destroyedItemCount();
 }
 
 
 void MineFieldItem::initField( int numRows, int numCols, int numMines )
 {
-    numMines = qMin(numMines, numRows*numCols - MINIMAL_FREE );
+    m_field.init(numRows, numCols, numMines);
+    qCDebug(KMINES_LOG) << "Field" << numRows << "x" << numCols << "cell storage:"
+                        << m_field.memoryUsage() << "bytes";
 
     m_firstClick = true;
     m_gameOver = false;
 
-    int oldSize = m_cells.size();
-    int newSize = numRows*numCols;
-    int oldBorderSize = m_borders.size();
-    int newBorderSize = (numCols+2)*2 + (numRows+2)*2-4;
-
-    // if field is being shrunk, delete elements at the end before resizing vector
-    if(oldSize > newSize)
-    {
-        for( int i=newSize; i<oldSize; ++i )
-        {
-            // is this the best way to remove an item?
-            scene()->removeItem(m_cells[i]);
-            delete m_cells[i];
-        }
-
-        // adjust border item array too
-        for( int i=newBorderSize; i<oldBorderSize; ++i)
-        {
-            scene()->removeItem(m_borders[i]);
-            delete m_borders[i];
-        }
-    }
-
-    m_cells.resize(newSize);
-    m_borders.resize(newBorderSize);
-
     m_numRows = numRows;
     m_numCols = numCols;
-    m_minesCount = numMines;
-    m_numUnrevealed = m_numRows*m_numCols;
     m_midButtonPos = qMakePair(-1, -1);
     m_leftButtonPos = qMakePair(-1, -1);
 
-    for(int i=0; i<newSize; ++i)
-    {
-        // reset old, create new
-        if(i<oldSize)
-            m_cells[i]->reset();
-        else
-            m_cells[i] = new CellItem(m_renderer, this);
-        // let it be empty by default
-        // generateField() will adjust needed cells
-        // to hold digits or mines
-        m_cells[i]->setDigit(0);
-    }
-
-    for(int i=oldBorderSize; i<newBorderSize; ++i)
-            m_borders[i] = new BorderItem(m_renderer, this);
-
-    setupBorderItems();
-
-    adjustItemPositions();
-    m_flaggedMinesCount = 0;
-    Q_EMIT flaggedMinesCountChanged(m_flaggedMinesCount);
+    m_border->setFieldSize(numRows, numCols);
+    m_miniMap->init(numRows, numCols);
+    // new field starts fitted into the view, see resizeToFitInRect()
+    m_zoom = 1.0;
+    m_scroll = QPoint(0, 0);
+    // recycle cell items for the new field
+    updateVisibleItems();
+
+    m_reportedFlaggedCount = m_field.flaggedCount();
+    Q_EMIT flaggedMinesCountChanged(m_reportedFlaggedCount);
+    m_createdItemsAtStart = CellItem::createdItemCount();
+    m_destroyedItemsAtStart = CellItem::destroyedItemCount();
 }
 
-void MineFieldItem::generateField(int clickedIdx)
+void MineFieldItem::setBatchedRendering(bool batched)
 {
-    // generating mines ensuring that clickedIdx won't hold mine
-    // and that it will be an empty cell so the user don't have
-    // to make random guesses at the start of the game
-    QList<int> cellsWithMines;
-    int minesToPlace = m_minesCount;
-    int randomIdx = 0;
-    CellItem* item = nullptr;
-    FieldPos fp = rowColFromIndex(clickedIdx);
+    m_batchedSetting = batched;
+    updateRenderMode();
+}
 
-    // this is the list of items we don't want to put the mine in
-    // to ensure that clickedIdx will stay an empty cell
-    // (it will be empty if none of surrounding items holds mine)
-    QList<CellItem*> neighbForClicked = adjacentItemsFor(fp.first, fp.second);
+void MineFieldItem::updateRenderMode()
+{
+    // zoomed out below readable cells, too many cells are visible to
+    // give each its own item
+    const bool batched = m_batchedSetting || m_cellSize < MinimumCellSize;
+    if(batched == m_batchedRendering)
+        return;
 
-    QRandomGenerator random(QRandomGenerator::global()->generate());
-    while(minesToPlace != 0)
+    m_batchedRendering = batched;
+    setFlag(QGraphicsItem::ItemHasNoContents, !batched);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, batched);
+    // no cell items are needed when paint() draws the cells
+    if(batched)
     {
-        randomIdx = random.bounded( m_numRows*m_numCols );
-        item = m_cells.at(randomIdx);
-        if(!item->hasMine()
-           && neighbForClicked.indexOf(item) == -1
-           && randomIdx != clickedIdx)
-        {
-            // ok, let's mine this place! :-)
-            item->setHasMine(true);
-            cellsWithMines.append(randomIdx);
-            minesToPlace--;
-        }
-        else
-            continue;
-    }
-
-    for (int idx : std::as_const(cellsWithMines)) {
-        FieldPos rc = rowColFromIndex(idx);
-        const QList<CellItem*> neighbours = adjacentItemsFor(rc.first, rc.second);
-        for (CellItem *item : neighbours) {
-            if(!item->hasMine())
-                item->setDigit( item->digit()+1 );
-        }
+        qDeleteAll(m_cells);
+        m_cells.clear();
     }
-}
-
-void MineFieldItem::setupBorderItems()
-{
-    int i = 0;
-    for(int row=0; row<m_numRows+2; ++row)
-        for(int col=0; col<m_numCols+2; ++col)
-        {
-            if( row == 0 && col == 0)
-            {
-                m_borders.at(i)->setRowCol(0,0);
-                m_borders.at(i)->setBorderType(KMinesState::BorderCornerNW);
-                i++;
-            }
-            else if( row == 0 && col == m_numCols+1)
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderCornerNE);
-                i++;
-            }
-            else if( row == m_numRows+1 && col == 0 )
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderCornerSW);
-                i++;
-            }
-            else if( row == m_numRows+1 && col == m_numCols+1 )
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderCornerSE);
-                i++;
-            }
-            else if( row == 0 )
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderNorth);
-                i++;
-            }
-            else if( row == m_numRows+1 )
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderSouth);
-                i++;
-            }
-            else if( col == 0 )
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderWest);
-                i++;
-            }
-            else if( col == m_numCols+1 )
-            {
-                m_borders.at(i)->setRowCol(row,col);
-                m_borders.at(i)->setBorderType(KMinesState::BorderEast);
-                i++;
-            }
-        }
+    updateVisibleItems();
 }
 
 QRectF MineFieldItem::boundingRect() const
 {
-    // +2 - because of border on each side
-    return QRectF(0, 0, m_cellSize*(m_numCols+2), m_cellSize*(m_numRows+2));
+    // the visible part of the field, see resizeToFitInRect()
+    return QRectF(0, 0, m_viewSize.width(), m_viewSize.height());
 }
 
 int MineFieldItem::rowCount() const
@@ -222,19 +136,53 @@ int MineFieldItem::columnCount() const
 
 int MineFieldItem::minesCount() const
 {
-    return m_minesCount;
+    return m_field.minesCount();
 }
 
 void MineFieldItem::paint( QPainter * painter, const QStyleOptionGraphicsItem* opt, QWidget* w)
 {
-    Q_UNUSED(painter);
-    Q_UNUSED(opt);
     Q_UNUSED(w);
+    if(!m_batchedRendering)
+        return;
+
+    // cells intersecting the exposed rect, +1 - because of border on each side
+    const QRectF exposed = opt->exposedRect.translated(m_scroll);
+    const int firstRow = qMax(0, static_cast<int>(exposed.top()/m_cellSize) - 1);
+    const int lastRow = qMin(m_numRows-1, static_cast<int>(exposed.bottom()/m_cellSize) - 1);
+    const int firstCol = qMax(0, static_cast<int>(exposed.left()/m_cellSize) - 1);
+    const int lastCol = qMin(m_numCols-1, static_cast<int>(exposed.right()/m_cellSize) - 1);
+
+    // group cells by their look, then draw each group with one call.
+    // The source is in device pixels of the pixmap, scaled back to the
+    // cell size
+    const QSize deviceSize = m_pixmapCache.deviceSize();
+    const QRectF source(0, 0, deviceSize.width(), deviceSize.height());
+    const qreal scaleX = deviceSize.isEmpty() ? 1.0 : qreal(m_cellSize) / deviceSize.width();
+    const qreal scaleY = deviceSize.isEmpty() ? 1.0 : qreal(m_cellSize) / deviceSize.height();
+    for(int row=firstRow; row<=lastRow; ++row)
+        for(int col=firstCol; col<=lastCol; ++col)
+        {
+            const int idx = m_field.index(row,col);
+            const int key = CellPixmapCache::key(m_field.state(idx), m_field.digit(idx),
+                                                 m_field.hasMine(idx), m_field.isExploded(idx));
+            QList<QPainter::PixmapFragment>& fragments = m_fragments[key];
+            if(fragments.isEmpty())
+                m_usedKeys.append(key);
+            const QPointF center((col+1.5)*m_cellSize - m_scroll.x(), (row+1.5)*m_cellSize - m_scroll.y());
+            fragments.append(QPainter::PixmapFragment::create(center, source, scaleX, scaleY));
+        }
+
+    for (int key : std::as_const(m_usedKeys)) {
+        QList<QPainter::PixmapFragment>& fragments = m_fragments[key];
+        painter->drawPixmapFragments(fragments.constData(), fragments.size(), m_pixmapCache.pixmap(key));
+        fragments.clear();
+    }
+    m_usedKeys.clear();
 }
 
-void MineFieldItem::resizeToFitInRect(const QRectF& rect)
+void MineFieldItem::resizeToFitInRect(const QRectF& rect, bool interim)
 {
-    prepareGeometryChange();
+    m_fitRect = rect;
 
     // +2 in some places - because of border on each side
 
@@ -253,91 +201,262 @@ void MineFieldItem::resizeToFitInRect(const QRectF& rect)
     else
         size = rect.height() / (m_numRows+2);
 
-    m_cellSize = static_cast<int>(size);
+    // large fields don't fit, they get scrolled instead, or zoomed out
+    // down to overviewCellSize
+    const int fitCellSize = qMax(static_cast<int>(size), MinimumCellSize);
+    const int overviewCellSize = qMax(static_cast<int>(size), MinimumZoomedCellSize);
 
-    for (CellItem* item : std::as_const(m_cells)) {
-        item->setRenderSize(QSize(m_cellSize, m_cellSize));
+    if(interim && !m_pixmapCache.renderSize().isEmpty())
+    {
+        // keep the sprites rendered for the last size and scale them
+        setCellSize(m_cellSize, boundingRect().center(), static_cast<qreal>(fitCellSize) / m_fitCellSize);
+        return;
     }
+    m_fitCellSize = fitCellSize;
+    m_overviewCellSize = overviewCellSize;
+    m_zoom = qMax(m_zoom, minimumZoom());
+    setCellSize(qRound(m_fitCellSize * m_zoom), boundingRect().center());
+}
+
+void MineFieldItem::setCellSize(int cellSize, const QPointF& anchor, qreal scale)
+{
+    // field point under anchor, to be kept there
+    const QPointF sceneAnchor = mapToScene(anchor);
+    const QPointF fieldAnchor = (anchor + m_scroll) / m_cellSize;
 
-    for (BorderItem *item : std::as_const(m_borders)) {
-        item->setRenderSize(QSize(m_cellSize, m_cellSize));
+    prepareGeometryChange();
+    setScale(scale);
+    m_cellSize = cellSize;
+    // the view is m_fitRect in scene coordinates
+    m_viewSize = QSize(qMin(m_cellSize*(m_numCols+2), static_cast<int>(m_fitRect.width() / scale)),
+                       qMin(m_cellSize*(m_numRows+2), static_cast<int>(m_fitRect.height() / scale)));
+    setPos( m_fitRect.x() + m_fitRect.width()/2 - m_viewSize.width()*scale/2,
+            m_fitRect.y() + m_fitRect.height()/2 - m_viewSize.height()*scale/2 );
+
+    updateRenderSize();
+    updateRenderMode();
+
+    // the map is only needed when part of the field is out of view
+    m_miniMap->setVisible(m_viewSize.width() < m_cellSize*(m_numCols+2)
+                          || m_viewSize.height() < m_cellSize*(m_numRows+2));
+    m_miniMap->setPos(m_viewSize.width() - m_miniMap->boundingRect().width() - MiniMapMargin, MiniMapMargin);
+
+    setScroll((fieldAnchor * m_cellSize - mapFromScene(sceneAnchor)).toPoint());
+    qCDebug(KMINES_LOG) << "Cell size" << m_cellSize << "visible cells" << m_visibleCells.size()
+                        << "cell items:" << m_cells.size();
+}
+
+void MineFieldItem::setDevicePixelRatio(qreal dpr)
+{
+    if(dpr == m_dpr)
+        return;
+    m_dpr = dpr;
+    // before the first resize there is nothing to render yet
+    if(!m_pixmapCache.renderSize().isEmpty())
+        updateRenderSize();
+}
+
+void MineFieldItem::updateRenderSize()
+{
+    const QSize renderSize(m_cellSize, m_cellSize);
+    if(m_pixmapCache.renderSize() != renderSize || m_pixmapCache.devicePixelRatio() != m_dpr)
+    {
+        m_pixmapCache.setRenderSize(renderSize, m_dpr);
+        updateAllPixmaps();
     }
+    m_border->setCellSize(m_cellSize, m_dpr);
+}
 
-    adjustItemPositions();
+void MineFieldItem::setScroll(const QPoint& scroll)
+{
+    // +2 - because of border on each side
+    const int maxX = qMax(0, m_cellSize*(m_numCols+2) - m_viewSize.width());
+    const int maxY = qMax(0, m_cellSize*(m_numRows+2) - m_viewSize.height());
+    m_scroll = QPoint(qBound(0, scroll.x(), maxX), qBound(0, scroll.y(), maxY));
+    updateVisibleItems();
+    // -1 - because of border on each side
+    m_miniMap->setViewRect(QRectF(QPointF(m_scroll) / m_cellSize - QPointF(1, 1),
+                                  QSizeF(m_viewSize) / m_cellSize));
 }
 
-void MineFieldItem::adjustItemPositions()
+void MineFieldItem::centerOn(int row, int col)
 {
-    Q_ASSERT( m_cells.size() == m_numRows*m_numCols );
+    // +1 - because of border on each side
+    setScroll(QPoint((col+1)*m_cellSize + m_cellSize/2 - m_viewSize.width()/2,
+                     (row+1)*m_cellSize + m_cellSize/2 - m_viewSize.height()/2));
+}
 
-    for(int row=0; row<m_numRows; ++row)
-        for(int col=0; col<m_numCols; ++col)
+void MineFieldItem::updateVisibleItems()
+{
+    // tiles touching the view plus a margin. Tile (row,col) is cell
+    // (row-1,col-1), tiles in rows 0, m_numRows+1 and columns 0, m_numCols+1
+    // are the border
+    const int firstRow = qMax(0, m_scroll.y()/m_cellSize - VisibleMargin);
+    const int lastRow = qMin(m_numRows+1, (m_scroll.y() + m_viewSize.height())/m_cellSize + VisibleMargin);
+    const int firstCol = qMax(0, m_scroll.x()/m_cellSize - VisibleMargin);
+    const int lastCol = qMin(m_numCols+1, (m_scroll.x() + m_viewSize.width())/m_cellSize + VisibleMargin);
+
+    m_visibleCells = QRect(QPoint(qMax(firstCol, 1) - 1, qMax(firstRow, 1) - 1),
+                           QPoint(qMin(lastCol, m_numCols) - 1, qMin(lastRow, m_numRows) - 1));
+
+    // cell items are laid out row by row over m_visibleCells
+    const int numCells = m_batchedRendering ? 0 : visibleCellCount();
+    while(m_cells.size() < numCells)
+        m_cells.append(new CellItem(&m_pixmapCache, -1, this));
+    for(int i=0; i<m_cells.size(); ++i)
+    {
+        CellItem* item = m_cells.at(i);
+        if(i >= numCells)
         {
-            itemAt(row,col)->setPos((col+1)*m_cellSize, (row+1)*m_cellSize);
+            item->hide();
+            continue;
         }
-
-    for (BorderItem* item : std::as_const(m_borders)) {
-        item->setPos( item->col()*m_cellSize, item->row()*m_cellSize );
+        const int row = m_visibleCells.top() + i / m_visibleCells.width();
+        const int col = m_visibleCells.left() + i % m_visibleCells.width();
+        item->setIndex(m_field.index(row,col));
+        item->setPos((col+1)*m_cellSize - m_scroll.x(), (row+1)*m_cellSize - m_scroll.y());
+        updateItem(item->index());
+        item->show();
     }
+
+    // the border scrolls as a whole
+    m_border->setPos(-m_scroll);
+
+    if(m_batchedRendering)
+        update();
+}
+
+int MineFieldItem::visibleCellCount() const
+{
+    return m_visibleCells.isEmpty() ? 0 : m_visibleCells.width()*m_visibleCells.height();
+}
+
+FieldPos MineFieldItem::cellAt(const QPointF& pos) const
+{
+    // parts of the field scrolled out of the view can't be clicked
+    if(!boundingRect().contains(pos))
+        return qMakePair(-1, -1);
+    // -1 - because of border on each side
+    return qMakePair(static_cast<int>((pos.y() + m_scroll.y())/m_cellSize) - 1,
+                     static_cast<int>((pos.x() + m_scroll.x())/m_cellSize) - 1);
 }
 
-bool MineFieldItem::onItemRevealed(int row, int col)
+void MineFieldItem::updateItem(int idx)
 {
-    m_numUnrevealed--;
-    if(itemAt(row,col)->hasMine())
+    const int row = idx / m_numCols;
+    const int col = idx % m_numCols;
+    // cells outside the view have no item and aren't painted, they get
+    // updated once scrolled in
+    if(!m_visibleCells.contains(col, row))
+        return;
+    if(m_batchedRendering)
     {
-        revealAllMines();
+        update((col+1)*m_cellSize - m_scroll.x(), (row+1)*m_cellSize - m_scroll.y(), m_cellSize, m_cellSize);
+        return;
     }
-    else if(itemAt(row,col)->digit() == 0) // empty cell
+    const int i = (row - m_visibleCells.top())*m_visibleCells.width() + col - m_visibleCells.left();
+    m_cells.at(i)->setCellState(m_field.state(idx), m_field.digit(idx),
+                                m_field.hasMine(idx), m_field.isExploded(idx));
+}
+
+void MineFieldItem::updateChangedItems()
+{
+    for (int idx : m_field.changedCells()) {
+        m_miniMap->setCellState(idx, m_field.state(idx), m_field.hasMine(idx), m_field.isExploded(idx));
+        updateItem(idx);
+    }
+    m_field.clearChangedCells();
+}
+
+void MineFieldItem::commitChanges()
+{
+    updateChangedItems();
+    if(m_field.flaggedCount() != m_reportedFlaggedCount)
     {
-        revealEmptySpace(row,col);
+        m_reportedFlaggedCount = m_field.flaggedCount();
+        Q_EMIT flaggedMinesCountChanged(m_reportedFlaggedCount);
     }
-    // now let's check for possible win/loss
-    if(checkLost())
-        return true;
-    return checkWon();
+    checkGameOver();
 }
 
-void MineFieldItem::revealEmptySpace(int row, int col)
+void MineFieldItem::updateAllItems()
 {
-    // recursively reveal neighbour cells until we find cells with digit
-    const QList<FieldPos> list = adjacentRowColsFor(row,col);
-    CellItem *item = nullptr;
+    if(m_batchedRendering)
+    {
+        update();
+        return;
+    }
+    const int numCells = visibleCellCount();
+    for(int i=0; i<numCells; ++i)
+        updateItem(m_cells.at(i)->index());
+}
 
-    for (const FieldPos& pos : list) {
-        // first is row, second is col
-        item = itemAt(pos);
-        if(item->isRevealed() || item->isFlagged() || item->isQuestioned())
-            continue;
-        if(item->digit() == 0)
-        {
-            item->reveal();
-            m_numUnrevealed--;
-            revealEmptySpace(pos.first,pos.second);
-        }
-        else
-        {
-            item->reveal();
-            m_numUnrevealed--;
-        }
+void MineFieldItem::updateAllPixmaps()
+{
+    if(m_batchedRendering)
+    {
+        update();
+        return;
+    }
+    // hidden items too, they are shown again without a state change
+    for (CellItem* item : std::as_const(m_cells)) {
+        item->updatePixmap();
     }
 }
 
-void MineFieldItem::handleFlag(CellItem* itemUnderMouse)
+void MineFieldItem::onSpritesChanged()
 {
-    bool wasFlagged = itemUnderMouse->isFlagged();
+    m_spritesChangedPending = false;
+    updateAllPixmaps();
+}
 
-    itemUnderMouse->mark();
+bool MineFieldItem::spritesReady() const
+{
+    return m_pixmapCache.isReady() && m_border->isReady();
+}
 
-    bool flagStateChanged = (itemUnderMouse->isFlagged() != wasFlagged);
-    if(flagStateChanged)
+qreal MineFieldItem::minimumZoom() const
+{
+    // fields that fit at MinimumCellSize are not zoomed out any further
+    return qMin(1.0, static_cast<qreal>(m_overviewCellSize) / m_fitCellSize);
+}
+
+void MineFieldItem::wheelEvent( QGraphicsSceneWheelEvent *ev )
+{
+    if(ev->modifiers() & Qt::ControlModifier)
     {
-        if(itemUnderMouse->isFlagged())
-            m_flaggedMinesCount++;
+        const qreal factor = ev->delta() > 0 ? ZoomStep : 1/ZoomStep;
+        m_zoom = qBound(minimumZoom(), m_zoom*factor, MaximumZoom);
+        setCellSize(qRound(m_fitCellSize * m_zoom), ev->pos());
+    }
+    else
+    {
+        // one wheel step (120) scrolls by three cells
+        const int distance = -ev->delta() * m_cellSize / 40;
+        if(ev->orientation() == Qt::Horizontal || (ev->modifiers() & Qt::ShiftModifier))
+            setScroll(m_scroll + QPoint(distance, 0));
         else
-            m_flaggedMinesCount--;
-        Q_EMIT flaggedMinesCountChanged(m_flaggedMinesCount);
+            setScroll(m_scroll + QPoint(0, distance));
     }
+    ev->accept();
+}
+
+bool MineFieldItem::checkGameOver()
+{
+    if(m_gameOver || !m_field.isGameOver())
+        return m_gameOver;
+
+    m_gameOver = true;
+    qCDebug(KMINES_LOG) << "Game over, cell graphics items created:"
+                        << CellItem::createdItemCount() - m_createdItemsAtStart
+                        << "destroyed:" << CellItem::destroyedItemCount() - m_destroyedItemsAtStart;
+    Q_EMIT gameOver(m_field.isWon());
+    return true;
+}
+
+void MineFieldItem::handleFlag(int row, int col)
+{
+    m_field.mark(m_field.index(row,col), Settings::useQuestionMarks());
 }
 
 void MineFieldItem::mousePressEvent( QGraphicsSceneMouseEvent *ev )
@@ -345,47 +464,43 @@ void MineFieldItem::mousePressEvent( QGraphicsSceneMouseEvent *ev )
     if(m_gameOver)
         return;
 
-    int row = static_cast<int>(ev->pos().y()/m_cellSize)-1;
-    int col = static_cast<int>(ev->pos().x()/m_cellSize)-1;
+    const FieldPos pos = cellAt(ev->pos());
+    const int row = pos.first;
+    const int col = pos.second;
     if( row <0 || row >= m_numRows || col < 0 || col >= m_numCols )
         return;
 
-    CellItem* itemUnderMouse = itemAt(row,col);
-    if(!itemUnderMouse)
-    {
-        qCDebug(KMINES_LOG) << "unexpected - no item under mouse";
-        return;
-    }
+    const int idx = m_field.index(row,col);
 
     bool useFastExplore = Settings::exploreWithLeftClickOnNumberCells();
     bool placeFlagWhenPressed = Settings::placeFlagOn() == Settings::EnumPlaceFlagOn::MousePress;
-    m_emulatingMidButton = ( useFastExplore ? ( (ev->buttons() & Qt::LeftButton) && ( itemUnderMouse->isRevealed() ) ) : ( (ev->buttons() & Qt::LeftButton) && (ev->buttons() & Qt::RightButton) ) );
+    m_emulatingMidButton = ( useFastExplore ? ( (ev->buttons() & Qt::LeftButton) && ( m_field.isRevealed(idx) ) ) : ( (ev->buttons() & Qt::LeftButton) && (ev->buttons() & Qt::RightButton) ) );
     bool midButtonPressed = (ev->button() == Qt::MiddleButton || m_emulatingMidButton );
 
     if(midButtonPressed)
     {
         // in case we just started mid-button emulation (first LeftClick then added a RightClick)
         // undo press that was made by LeftClick. in other cases it won't hurt :)
-        itemUnderMouse->undoPress();
-
-        const QList<CellItem*> neighbours = adjacentItemsFor(row,col);
-        for (CellItem* item : neighbours) {
-            if(!item->isFlagged() && !item->isQuestioned() && !item->isRevealed())
-                item->press();
-            m_midButtonPos = qMakePair(row,col);
+        m_field.undoPress(idx);
 
-            m_leftButtonPos = qMakePair(-1,-1); // reset it
+        const MineField::Neighbours neighbours = m_field.adjacentCells(idx);
+        for (int neighbour : neighbours) {
+            if(!m_field.isFlagged(neighbour) && !m_field.isQuestioned(neighbour) && !m_field.isRevealed(neighbour))
+                m_field.press(neighbour);
         }
+        m_midButtonPos = qMakePair(row,col);
+        m_leftButtonPos = qMakePair(-1,-1); // reset it
     }
     else if(ev->button() == Qt::LeftButton)
     {
-        itemUnderMouse->press();
+        m_field.press(idx);
         m_leftButtonPos = qMakePair(row,col);
     }
     else if(placeFlagWhenPressed && ev->button() == Qt::RightButton && (ev->buttons() & Qt::LeftButton) == false)
     {
-        handleFlag(itemUnderMouse);
+        handleFlag(row,col);
     }
+    commitChanges();
 }
 
 void MineFieldItem::mouseReleaseEvent( QGraphicsSceneMouseEvent * ev)
@@ -393,8 +508,9 @@ void MineFieldItem::mouseReleaseEvent( QGraphicsSceneMouseEvent * ev)
     if(m_gameOver)
         return;
 
-    int row = static_cast<int>(ev->pos().y()/m_cellSize)-1;
-    int col = static_cast<int>(ev->pos().x()/m_cellSize)-1;
+    const FieldPos pos = cellAt(ev->pos());
+    const int row = pos.first;
+    const int col = pos.second;
 
     if( row <0 || row >= m_numRows || col < 0 || col >= m_numCols )
     {
@@ -404,9 +520,9 @@ void MineFieldItem::mouseReleaseEvent( QGraphicsSceneMouseEvent * ev)
         // and return
         if(m_midButtonPos.first != -1)
         {
-            const QList<CellItem*> neighbours = adjacentItemsFor(m_midButtonPos.first,m_midButtonPos.second);
-            for (CellItem *item : neighbours) {
-                item->undoPress();
+            const MineField::Neighbours neighbours = m_field.adjacentCells(m_field.index(m_midButtonPos.first,m_midButtonPos.second));
+            for (int neighbour : neighbours) {
+                m_field.undoPress(neighbour);
             }
             m_midButtonPos = qMakePair(-1,-1);
             m_emulatingMidButton = false;
@@ -414,13 +530,15 @@ void MineFieldItem::mouseReleaseEvent( QGraphicsSceneMouseEvent * ev)
         // same with left button
         if(m_leftButtonPos.first != -1)
         {
-            itemAt(m_leftButtonPos)->undoPress();
+            const int idx = m_field.index(m_leftButtonPos.first,m_leftButtonPos.second);
+            m_field.undoPress(idx);
             m_leftButtonPos = qMakePair(-1,-1);
         }
+        commitChanges();
         return;
     }
 
-    CellItem* itemUnderMouse = itemAt(row,col);
+    const int idx = m_field.index(row,col);
 
     bool placeFlagWhenReleased = Settings::placeFlagOn() == Settings::EnumPlaceFlagOn::MouseRelease;
     bool midButtonReleased = (ev->button() == Qt::MiddleButton || m_emulatingMidButton);
@@ -429,51 +547,15 @@ void MineFieldItem::mouseReleaseEvent( QGraphicsSceneMouseEvent * ev)
     {
         m_midButtonPos = qMakePair(-1,-1);
 
-        const QList<CellItem*> neighbours = adjacentItemsFor(row,col);
-        if(!itemUnderMouse->isRevealed())
-        {
-            for (CellItem *item : neighbours) {
-                item->undoPress();
-            }
-            return;
-        }
-
-        int numFlags = 0;
-        int numMines = 0;
-        for (CellItem *item : neighbours) {
-            if(item->isFlagged())
-                numFlags++;
-            if(item->hasMine())
-                numMines++;
-        }
-        if(numFlags == numMines && numFlags != 0)
-        {
-            for (CellItem *item : neighbours) {
-                if(!item->isRevealed()) // revealing only unrevealed ones
-                {
-                    // force=true to omit Pressed check
-                    item->release(true);
-                    // If revealing the item ends the game, stop the loop,
-                    // since everything that needs to be done for the current game is finished.
-                    // Otherwise, if the user has restarted the game, we'll be revealing
-                    // items for the new game.
-                    if(item->isRevealed() && onItemRevealed(item))
-                        break;
-                }
-            }
-        }
-        else
-        {
-            for (CellItem *item : neighbours) {
-                item->undoPress();
-            }
-        }
+        m_field.chord(idx);
+        commitChanges();
     }
     else if(ev->button() == Qt::LeftButton && (ev->buttons() & Qt::RightButton) == false)
     {
         if(m_midButtonPos.first != -1) // mid-button is already pressed
         {
-            itemUnderMouse->undoPress();
+            m_field.undoPress(idx);
+            commitChanges();
             return;
         }
 
@@ -483,24 +565,27 @@ void MineFieldItem::mouseReleaseEvent( QGraphicsSceneMouseEvent * ev)
         if(m_leftButtonPos.first == -1)
             return;
 
-        if(!itemUnderMouse->isRevealed()) // revealing only unrevealed ones
+        if(!m_field.isRevealed(idx)) // revealing only unrevealed ones
         {
             if(m_firstClick)
             {
                 m_firstClick = false;
-                generateField( row*m_numCols + col );
+                m_field.generate(idx, QRandomGenerator::global()->generate());
+                qCDebug(KMINES_LOG) << "Field generated, 3BV:" << m_field.threeBV()
+                                    << "openings:" << m_field.openingCount()
+                                    << "opening index:" << m_field.openingIndexMemoryUsage() << "bytes";
                 Q_EMIT firstClickDone();
             }
 
-            itemUnderMouse->release();
-            if(itemUnderMouse->isRevealed())
-                onItemRevealed(row,col);
+            m_field.open(idx);
+            commitChanges();
         }
         m_leftButtonPos = qMakePair(-1,-1);//reset
     }
     else if(placeFlagWhenReleased && ev->button() == Qt::RightButton && (ev->buttons() & Qt::LeftButton) == false)
     {
-        handleFlag(itemUnderMouse);
+        handleFlag(row,col);
+        commitChanges();
     }
 }
 
@@ -509,8 +594,9 @@ void MineFieldItem::mouseMoveEvent( QGraphicsSceneMouseEvent *ev )
     if(m_gameOver)
         return;
 
-    int row = static_cast<int>(ev->pos().y()/m_cellSize)-1;
-    int col = static_cast<int>(ev->pos().x()/m_cellSize)-1;
+    const FieldPos pos = cellAt(ev->pos());
+    const int row = pos.first;
+    const int col = pos.second;
 
     if( row < 0 || row >= m_numRows || col < 0 || col >= m_numCols )
         return;
@@ -524,16 +610,16 @@ void MineFieldItem::mouseMoveEvent( QGraphicsSceneMouseEvent *ev )
            (m_midButtonPos.first != row || m_midButtonPos.second != col))
         {
             // un-press previously pressed cells
-            const QList<CellItem*> prevNeighbours = adjacentItemsFor(m_midButtonPos.first,
-                                                                     m_midButtonPos.second);
-            for (CellItem *item : prevNeighbours) {
-                   item->undoPress();
+            const MineField::Neighbours prevNeighbours = m_field.adjacentCells(m_field.index(m_midButtonPos.first,
+                                                                                        m_midButtonPos.second));
+            for (int neighbour : prevNeighbours) {
+                m_field.undoPress(neighbour);
             }
 
             // and press current neighbours
-            const QList<CellItem*> neighbours = adjacentItemsFor(row,col);
-            for (CellItem *item : neighbours) {
-                item->press();
+            const MineField::Neighbours neighbours = m_field.adjacentCells(m_field.index(row,col));
+            for (int neighbour : neighbours) {
+                m_field.press(neighbour);
             }
 
             m_midButtonPos = qMakePair(row,col);
@@ -544,105 +630,14 @@ void MineFieldItem::mouseMoveEvent( QGraphicsSceneMouseEvent *ev )
         if((m_leftButtonPos.first != -1 && m_leftButtonPos.second != -1) &&
            (m_leftButtonPos.first != row || m_leftButtonPos.second != col))
         {
-            itemAt(m_leftButtonPos)->undoPress();
-            itemAt(row,col)->press();
+            const int prevIdx = m_field.index(m_leftButtonPos.first,m_leftButtonPos.second);
+            m_field.undoPress(prevIdx);
+            const int idx = m_field.index(row,col);
+            m_field.press(idx);
             m_leftButtonPos = qMakePair(row,col);
         }
     }
-}
-
-void MineFieldItem::revealAllMines()
-{
-    for (CellItem* item : std::as_const(m_cells)) {
-        if( (item->isFlagged() && !item->hasMine()) || (!item->isFlagged() && item->hasMine()) )
-        {
-            item->reveal();
-            m_numUnrevealed--;
-        }
-    }
-}
-
-bool MineFieldItem::onItemRevealed(CellItem* item)
-{
-    int idx = m_cells.indexOf(item);
-    if(idx == -1)
-    {
-        qCDebug(KMINES_LOG) << "really strange - item not found";
-        return false;
-    }
-
-    int row = idx / m_numCols;
-    int col = idx - row*m_numCols;
-    return onItemRevealed(row,col);
-}
-
-bool MineFieldItem::checkLost()
-{
-    // for loss...
-    for (CellItem* item : std::as_const(m_cells)) {
-        if(item->isExploded())
-        {
-            m_gameOver = true;
-            Q_EMIT gameOver(false);
-            return true;
-        }
-    }
-    return false;
-}
-
-bool MineFieldItem::checkWon()
-{
-    // this also takes into account the trivial case when
-    // only some cells left unflagged and they
-    // all contain bombs. this counts as win
-    if(m_numUnrevealed == m_minesCount)
-    {
-        // mark not flagged cells (if any) with flags
-        for (CellItem* item : std::as_const(m_cells)) {
-            if( item->isQuestioned() )
-                item->mark();
-            if( !item->isRevealed() && !item->isFlagged() )
-                item->mark();
-        }
-        m_gameOver = true;
-        // now all mines should be flagged, notify about this
-        Q_EMIT flaggedMinesCountChanged(m_minesCount);
-        Q_EMIT gameOver(true);
-        return true;
-    }
-    return false;
-}
-
-QList<FieldPos> MineFieldItem::adjacentRowColsFor(int row, int col)
-{
-    QList<FieldPos> resultingList;
-    if(row != 0 && col != 0) // upper-left diagonal
-        resultingList.append( qMakePair(row-1,col-1) );
-    if(row != 0) // upper
-        resultingList.append(qMakePair(row-1, col));
-    if(row != 0 && col != m_numCols-1) // upper-right diagonal
-        resultingList.append(qMakePair(row-1, col+1));
-    if(col != 0) // on the left
-        resultingList.append(qMakePair(row,col-1));
-    if(col != m_numCols-1) // on the right
-        resultingList.append(qMakePair(row, col+1));
-    if(row != m_numRows-1 && col != 0) // bottom-left diagonal
-        resultingList.append(qMakePair(row+1, col-1));
-    if(row != m_numRows-1) // bottom
-        resultingList.append(qMakePair(row+1, col));
-    if(row != m_numRows-1 && col != m_numCols-1) // bottom-right diagonal
-        resultingList.append(qMakePair(row+1, col+1));
-    return resultingList;
-}
-
-QList<CellItem*> MineFieldItem::adjacentItemsFor(int row, int col)
-{
-    const QList<FieldPos > rowcolList = adjacentRowColsFor(row,col);
-    QList<CellItem*> resultingList;
-    for (const FieldPos& pos : rowcolList) {
-        resultingList.append( itemAt(pos) );
-    }
-    return resultingList;
+    commitChanges();
 }
 
 #include "moc_minefielditem.cpp"
@@ -8,23 +8,33 @@
 #ifndef MINEFIELDITEM_H
 #define MINEFIELDITEM_H
 
+// own
+#include "cellpixmapcache.h"
+#include "minefield.h"
 // Qt
 #include <QGraphicsObject>
 #include <QList>
+#include <QPainter>
 #include <QPair>
+#include <QRect>
 
 class KGameRenderer;
 class CellItem;
 class BorderItem;
+class MiniMapItem;
 
 using FieldPos = QPair<int, int>;
 
 /**
  * Graphics item that represents MineField.
  * It is composed of many (or little) of CellItems.
- * This class is responsible of generation game field
- * with given properties (num rows, num cols, num mines) and
- * handling resizes
+ * This class translates mouse input into MineField operations,
+ * keeps cell items in sync with the field and handles resizes.
+ *
+ * The item is a viewport over the field: fields too large to fit
+ * with readable cells, or zoomed in with Ctrl+wheel, are scrolled
+ * with the wheel. Cell items exist only for the visible part
+ * and are recycled while scrolling
  */
 class MineFieldItem : public QGraphicsObject
 {
@@ -48,9 +58,34 @@ public:
      */
     void resetMines();
     /**
-     * Resizes this graphics item so it fits in given rect
+     * Switches between drawing cells as separate CellItems (default)
+     * and drawing the whole field in paint() from the field state,
+     * which keeps the number of scene items independent of field size.
+     * Below MinimumCellSize the field is always drawn batched
      */
-    void resizeToFitInRect(const QRectF& rect);
+    void setBatchedRendering(bool batched);
+    /**
+     * Resizes this graphics item so it fits in given rect and centers it
+     * there. Cells don't get smaller than MinimumCellSize, the rest of
+     * the field is reachable by scrolling, or by zooming out with
+     * Ctrl+wheel until the whole field fits, but not below
+     * MinimumZoomedCellSize.
+     *
+     * @param interim if true, nothing is re-rendered: the item is
+     * scaled from the last rendered size. Used while the window is
+     * being resized, to be followed by a call with interim false
+     */
+    void resizeToFitInRect(const QRectF& rect, bool interim = false);
+    /**
+     * Sets device pixel ratio of the screen the field is shown on.
+     * Sprites are rendered for it, the cell size stays in logical pixels
+     */
+    void setDevicePixelRatio(qreal dpr);
+    /**
+     * @return true if all sprites of cells and border are rendered for
+     * the current size, i.e. no placeholders are shown
+     */
+    bool spritesReady() const;
     /**
      * Reimplemented from QGraphicsItem
      */
@@ -71,12 +106,21 @@ public:
     /**
      * Minimal number of free positions on a field
      */
-    static const int MINIMAL_FREE = 10;
+    static const int MINIMAL_FREE = MineField::MINIMAL_FREE;
 
 Q_SIGNALS:
     void flaggedMinesCountChanged(int);
     void firstClickDone();
     void gameOver(bool won);
+private Q_SLOTS:
+    /**
+     * Refetches cell pixmaps once sprites arrived, see CellPixmapCache
+     */
+    void onSpritesChanged();
+    /**
+     * Scrolls the view so that cell (row,col) is in its center
+     */
+    void centerOn(int row, int col);
 private:
     // reimplemented
     void mousePressEvent( QGraphicsSceneMouseEvent * ) override;
@@ -84,111 +128,171 @@ private:
     void mouseReleaseEvent( QGraphicsSceneMouseEvent * ) override;
     // reimplemented
     void mouseMoveEvent( QGraphicsSceneMouseEvent * ) override;
+    // reimplemented
+    void wheelEvent( QGraphicsSceneWheelEvent * ) override;
 
     /**
-     * Returns cell item at (row,col).
-     * Always use this function instead hand-computing index in m_cells
+     * @return (row,col) of the cell at pos in item coordinates.
+     * Out of field range if there is no cell
      */
-    inline CellItem* itemAt(int row, int col) { return m_cells.at( row*m_numCols + col ); }
+    FieldPos cellAt(const QPointF& pos) const;
     /**
-     * Overloaded one, which takes QPair
+     * Changes cell size, keeping the field point at anchor in place.
+     * The item is drawn scaled by scale
      */
-    inline CellItem* itemAt( FieldPos pos ) { return itemAt(pos.first,pos.second); }
+    void setCellSize(int cellSize, const QPointF& anchor, qreal scale = 1.0);
     /**
-     * Calculates (row,col) from given index in m_cells and returns them in QPair
+     * Requests pixmaps of cells and border for the current cell size
+     * and device pixel ratio
      */
-    inline FieldPos rowColFromIndex(int idx)
-        {
-            int row = idx/m_numCols;
-            return qMakePair(row, idx - row*m_numCols);
-        }
+    void updateRenderSize();
     /**
-     * Generates game field ensuring that cell at clickedIdx
-     * will be empty to allow the player quickly jump into the game.
-     *
-     * @param clickedIdx specifies index which should NOT have mine and be empty
+     * Scrolls the view, so that field pixel scroll is at the top left corner
      */
-    void generateField(int clickedIdx);
+    void setScroll(const QPoint& scroll);
     /**
-     * Returns all adjacent items for item at row, col
+     * Assigns cell items to the cells in view
      */
-    QList<CellItem*> adjacentItemsFor(int row, int col);
+    void updateVisibleItems();
+    int visibleCellCount() const;
     /**
-     * Returns all valid adjacent row,col pairs for row, col
+     * Switches to batched rendering when requested by
+     * setBatchedRendering() or when cells are below MinimumCellSize
      */
-    QList<FieldPos> adjacentRowColsFor(int row, int col);
+    void updateRenderMode();
     /**
-     * Checks if player lost the game. Return `true` if lost.
-     * A `true` return value and a `false` `m_gameOver` indicates that the game is restarted.
+     * @return the smallest m_zoom, at which the whole field fits or
+     * cells are MinimumZoomedCellSize
      */
-    bool checkLost();
+    qreal minimumZoom() const;
     /**
-     * Checks if player won the game. Return `true` if won.
+     * Updates cell item at idx from the field
      */
-    bool checkWon();
+    void updateItem(int idx);
     /**
-     * Reveals all unmarked items containing mines
+     * Updates cell items changed by the last field operations
      */
-    void revealAllMines();
+    void updateChangedItems();
     /**
-     * Reimplemented from QGraphicsItem
+     * Ends the handling of a mouse event: updates the cell items changed
+     * by it in one pass, then emits flaggedMinesCountChanged() and
+     * gameOver() at most once each
      */
-    void paint( QPainter * painter, const QStyleOptionGraphicsItem*, QWidget * widget = nullptr ) override;
+    void commitChanges();
     /**
-     * Repositions all child cell items upon resizes
+     * Updates all cell items from the field
      */
-    void adjustItemPositions();
+    void updateAllItems();
     /**
-     * Reveals all empty cells around cell at (row,col),
-     * until it found cells with digits (which are also revealed)
+     * Refetches pixmaps of all cell items from m_pixmapCache
      */
-    void revealEmptySpace(int row, int col);
+    void updateAllPixmaps();
     /**
-     * Sets up border items (positions and properties)
+     * Emits signals about finished game if the field says it's over.
+     * Return `true` if the game is finished.
      */
-    void setupBorderItems();
+    bool checkGameOver();
     /**
-     * Changes the flag state of a clicked cell and updates mine count
+     * Reimplemented from QGraphicsItem
      */
-    void handleFlag(CellItem* itemUnderMouse);
+    void paint( QPainter * painter, const QStyleOptionGraphicsItem*, QWidget * widget = nullptr ) override;
     /**
-     * Return `true` if the game is finished (and possibly restarted) after the call.
+     * Changes the flag state of a clicked cell
      */
-    bool onItemRevealed(int row, int col);
-    // overload
-    bool onItemRevealed(CellItem* item);
+    void handleFlag(int row, int col);
 
-    // note: in member functions use itemAt (see above )
-    // instead of hand-computing index from row & col!
-    // => not depend on how m_cells is represented
     /**
-     * Array which holds all child cell items
+     * Logical field: mines, digits, cell states and game rules
+     */
+    MineField m_field;
+    /**
+     * Cell items of m_visibleCells, row by row, and spare hidden ones
      */
     QList<CellItem*> m_cells;
     /**
-     * Array which holds border items
+     * Cells having items, in (col,row) coordinates
+     */
+    QRect m_visibleCells;
+    /**
+     * Composited pixmaps shared by all cell items
+     */
+    CellPixmapCache m_pixmapCache;
+    /**
+     * True while an onSpritesChanged() call is queued
+     */
+    bool m_spritesChangedPending = false;
+    /**
+     * Value given to setBatchedRendering()
+     */
+    bool m_batchedSetting = false;
+    /**
+     * True while paint() draws the cells, see updateRenderMode()
+     */
+    bool m_batchedRendering = false;
+    /**
+     * Cells to draw in paint(), grouped by CellPixmapCache::key().
+     * Kept between paints to reuse the allocations
      */
-    QList<BorderItem*> m_borders;
+    QList<QList<QPainter::PixmapFragment>> m_fragments;
+    QList<int> m_usedKeys;
+    /**
+     * Frame around the field, drawn by one item
+     */
+    BorderItem* m_border = nullptr;
     /**
      * The width and height of minefield cells in scene coordinates
      */
     int m_cellSize = 1; // dummy init value for non-large boundingRect, non-null because used for divisions
     /**
-     * Number of field rows
+     * Cell size fitting the field into m_fitRect, at least MinimumCellSize
      */
-    int m_numRows = 1; // dummy init value for non-large boundingRect, non-null because used for divisions
+    int m_fitCellSize = 1;
     /**
-     * Number of field columns
+     * Cell size fitting the whole field into m_fitRect, at least
+     * MinimumZoomedCellSize. The smallest size zooming out goes to
      */
-    int m_numCols = 1; // dummy init value for non-large boundingRect, non-null because used for divisions
+    int m_overviewCellSize = 1;
+    /**
+     * Device pixel ratio pixmaps are rendered for
+     */
+    qreal m_dpr = 1.0;
+    /**
+     * Rect given to resizeToFitInRect()
+     */
+    QRectF m_fitRect;
+    /**
+     * Size of the visible part of the field
+     */
+    QSize m_viewSize;
+    /**
+     * Field pixel at the top left corner of the view
+     */
+    QPoint m_scroll;
     /**
-     * Number of mines in field
+     * m_cellSize relative to m_fitCellSize
      */
-    int m_minesCount;
+    qreal m_zoom = 1.0;
+    static constexpr int MinimumCellSize = 20;
+    static constexpr int MinimumZoomedCellSize = 4;
+    static constexpr qreal ZoomStep = 1.25;
+    static constexpr qreal MaximumZoom = 8.0;
     /**
-     * Number of flagged mines
+     * Overview shown in the top right corner when the field doesn't fit
      */
-    int m_flaggedMinesCount;
+    MiniMapItem* m_miniMap = nullptr;
+    static constexpr int MiniMapMargin = 8;
+    /**
+     * Tiles around the view which get items too
+     */
+    static constexpr int VisibleMargin = 1;
+    /**
+     * Number of field rows
+     */
+    int m_numRows = 1; // dummy init value for non-large boundingRect, non-null because used for divisions
+    /**
+     * Number of field columns
+     */
+    int m_numCols = 1; // dummy init value for non-large boundingRect, non-null because used for divisions
     /**
      * row and column where mouse was pressed.
      * (-1,-1) if it is already released
@@ -198,7 +302,16 @@ private:
     bool m_firstClick;
     bool m_gameOver;
     bool m_emulatingMidButton;
-    int m_numUnrevealed;
+    /**
+     * Flagged count last sent with flaggedMinesCountChanged()
+     */
+    int m_reportedFlaggedCount = 0;
+    /**
+     * CellItem::createdItemCount() and destroyedItemCount() at the start
+     * of the current game, to log how many items the game itself needed
+     */
+    int m_createdItemsAtStart = 0;
+    int m_destroyedItemsAtStart = 0;
 
     KGameRenderer* m_renderer;
 };
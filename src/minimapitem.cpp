@@ -0,0 +1,177 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "minimapitem.h"
+
+// Qt
+#include <QGraphicsSceneMouseEvent>
+#include <QPainter>
+// Std
+#include <iterator>
+
+static const QRgb s_categoryColors[] = {
+    qRgb(0x70, 0x70, 0x70), // Hidden
+    qRgb(0xd8, 0xd8, 0xd8), // Open
+    qRgb(0x30, 0x6c, 0xd0), // Flag
+    qRgb(0x20, 0x20, 0x20), // Mine
+    qRgb(0xe0, 0x90, 0x20), // WrongFlag
+    qRgb(0xe0, 0x20, 0x20)  // Boom
+};
+
+MiniMapItem::MiniMapItem(QGraphicsItem* parent)
+    : QGraphicsObject(parent)
+{
+    // also take other buttons, so that they don't reach the field below
+    setAcceptedMouseButtons(Qt::AllButtons);
+}
+
+void MiniMapItem::init(int numRows, int numCols)
+{
+    prepareGeometryChange();
+    m_numRows = numRows;
+    m_numCols = numCols;
+    m_blockSize = (qMax(numRows, numCols) + MaximumSize - 1) / MaximumSize;
+
+    m_cells = QImage(numCols, numRows, QImage::Format_Indexed8);
+    m_cells.setColorTable(QList<QRgb>(std::begin(s_categoryColors), std::end(s_categoryColors)));
+    m_cells.fill(Hidden);
+
+    const int blockCols = (numCols + m_blockSize - 1) / m_blockSize;
+    const int blockRows = (numRows + m_blockSize - 1) / m_blockSize;
+    m_blocks = QImage(blockCols, blockRows, QImage::Format_RGB32);
+    m_blocks.fill(s_categoryColors[Hidden]);
+    m_blockCounts.fill(0, blockCols * blockRows * CategoryCount);
+    for(int y=0; y<blockRows; ++y)
+        for(int x=0; x<blockCols; ++x)
+        {
+            // blocks at the right and bottom edges may be cut
+            const int width = qMin(m_blockSize, numCols - x*m_blockSize);
+            const int height = qMin(m_blockSize, numRows - y*m_blockSize);
+            m_blockCounts[(y*blockCols + x)*CategoryCount + Hidden] = width*height;
+        }
+    update();
+}
+
+void MiniMapItem::setCellState(int idx, KMinesState::CellState state, bool hasMine, bool exploded)
+{
+    const int row = idx / m_numCols;
+    const int col = idx % m_numCols;
+    uchar& cell = m_cells.scanLine(row)[col];
+    const Category newCategory = category(state, hasMine, exploded);
+    if(cell == newCategory)
+        return;
+
+    const int x = col / m_blockSize;
+    const int y = row / m_blockSize;
+    int* counts = &m_blockCounts[(y*m_blocks.width() + x)*CategoryCount];
+    counts[cell]--;
+    counts[newCategory]++;
+    cell = newCategory;
+    updateBlockPixel(x, y);
+}
+
+void MiniMapItem::updateBlockPixel(int x, int y)
+{
+    const int* counts = &m_blockCounts[(y*m_blocks.width() + x)*CategoryCount];
+    QRgb color;
+    if(counts[Boom] != 0)
+    {
+        // always make explosions stand out
+        color = s_categoryColors[Boom];
+    }
+    else
+    {
+        int total = 0, red = 0, green = 0, blue = 0;
+        for(int i=0; i<CategoryCount; ++i)
+        {
+            total += counts[i];
+            red += counts[i] * qRed(s_categoryColors[i]);
+            green += counts[i] * qGreen(s_categoryColors[i]);
+            blue += counts[i] * qBlue(s_categoryColors[i]);
+        }
+        color = qRgb(red / total, green / total, blue / total);
+    }
+    m_blocks.setPixel(x, y, color);
+
+    const qreal scale = boundingRect().width() / m_blocks.width();
+    update(x*scale, y*scale, scale, scale);
+}
+
+void MiniMapItem::setViewRect(const QRectF& cells)
+{
+    if(cells == m_viewRect)
+        return;
+    m_viewRect = cells;
+    update();
+}
+
+QRectF MiniMapItem::boundingRect() const
+{
+    if(m_blocks.isNull())
+        return QRectF();
+    // scale up small fields, so that each block gets a whole number of pixels
+    const int scale = qMax(1, MaximumSize / qMax(m_blocks.width(), m_blocks.height()));
+    return QRectF(0, 0, m_blocks.width()*scale, m_blocks.height()*scale);
+}
+
+void MiniMapItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget)
+{
+    Q_UNUSED(option);
+    Q_UNUSED(widget);
+    const QRectF rect = boundingRect();
+    painter->drawImage(rect, m_blocks);
+
+    // the part in view
+    const qreal scale = cellScale();
+    painter->setPen(Qt::yellow);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(QRectF(m_viewRect.topLeft() * scale, m_viewRect.size() * scale).intersected(rect));
+}
+
+void MiniMapItem::mousePressEvent(QGraphicsSceneMouseEvent* ev)
+{
+    if(ev->button() == Qt::LeftButton)
+        emitClicked(ev->pos());
+}
+
+void MiniMapItem::mouseMoveEvent(QGraphicsSceneMouseEvent* ev)
+{
+    // dragging over the map keeps moving the view
+    if(ev->buttons() & Qt::LeftButton)
+        emitClicked(ev->pos());
+}
+
+void MiniMapItem::emitClicked(const QPointF& pos)
+{
+    const qreal scale = cellScale();
+    const int row = qBound(0, static_cast<int>(pos.y() / scale), m_numRows-1);
+    const int col = qBound(0, static_cast<int>(pos.x() / scale), m_numCols-1);
+    Q_EMIT clicked(row, col);
+}
+
+qreal MiniMapItem::cellScale() const
+{
+    return boundingRect().width() / m_blocks.width() / m_blockSize;
+}
+
+MiniMapItem::Category MiniMapItem::category(KMinesState::CellState state, bool hasMine, bool exploded)
+{
+    switch(state)
+    {
+        case KMinesState::Revealed:
+            if(exploded)
+                return Boom;
+            return hasMine ? Mine : Open;
+        case KMinesState::Error:
+            return WrongFlag;
+        case KMinesState::Flagged:
+            return Flag;
+        default:
+            return Hidden;
+    }
+}
+
+#include "moc_minimapitem.cpp"
@@ -0,0 +1,102 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef MINIMAPITEM_H
+#define MINIMAPITEM_H
+
+// own
+#include "commondefs.h"
+// Qt
+#include <QGraphicsObject>
+#include <QImage>
+#include <QList>
+
+/**
+ * Overview of a field larger than the view: shows revealed, flagged
+ * and unrevealed regions and the part of the field in view. At the end
+ * of the game also mines, wrong flags and, standing out, the explosion.
+ * Clicking it asks to center the view there.
+ *
+ * Cells are kept in a 1-pixel-per-cell image. What is displayed is a
+ * downscaled image of at most MaximumSize pixels per side, each pixel
+ * mixing the colors of the cells it covers. Both are updated per changed
+ * cell in constant time, they are only filled as a whole on init().
+ */
+class MiniMapItem : public QGraphicsObject
+{
+    Q_OBJECT
+public:
+    explicit MiniMapItem(QGraphicsItem* parent);
+    /**
+     * Sets field size and marks all cells unrevealed
+     */
+    void init(int numRows, int numCols);
+    /**
+     * Updates the cell at idx (row*numCols + col)
+     */
+    void setCellState(int idx, KMinesState::CellState state, bool hasMine, bool exploded);
+    /**
+     * Sets the part of the field in view, in (col,row) cell coordinates
+     */
+    void setViewRect(const QRectF& cells);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget = nullptr) override;
+
+    /**
+     * Largest width and height of the displayed image in pixels
+     */
+    static const int MaximumSize = 160;
+
+Q_SIGNALS:
+    /**
+     * Emitted when the map is clicked at cell (row,col)
+     */
+    void clicked(int row, int col);
+private:
+    void mousePressEvent(QGraphicsSceneMouseEvent* ev) override;
+    void mouseMoveEvent(QGraphicsSceneMouseEvent* ev) override;
+    /**
+     * Emits clicked() for the cell at pos
+     */
+    void emitClicked(const QPointF& pos);
+
+    /**
+     * What the map distinguishes, also color indices of m_cells
+     */
+    enum Category { Hidden, Open, Flag, Mine, WrongFlag, Boom, CategoryCount };
+    static Category category(KMinesState::CellState state, bool hasMine, bool exploded);
+    /**
+     * @return size of a cell in item coordinates
+     */
+    qreal cellScale() const;
+    /**
+     * Recomputes the color of the displayed pixel (x,y) from its counts
+     */
+    void updateBlockPixel(int x, int y);
+
+    int m_numRows = 0;
+    int m_numCols = 0;
+    /**
+     * Side of the square of cells shown by one displayed pixel
+     */
+    int m_blockSize = 1;
+    /**
+     * Category of each cell, one byte per cell
+     */
+    QImage m_cells;
+    /**
+     * Displayed image, one pixel per block of cells
+     */
+    QImage m_blocks;
+    /**
+     * Number of cells of each category per block
+     */
+    QList<int> m_blockCounts;
+    QRectF m_viewRect;
+};
+
+#endif
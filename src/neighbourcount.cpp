@@ -0,0 +1,110 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "neighbourcount.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define KMINES_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+// Sums of up to 8 bytes holding 0 or 1 never overflow a byte lane,
+// so all kernels add whole rows lane-wise and mask out the mines.
+
+static void countScalar(const std::uint8_t* above, const std::uint8_t* row,
+                        const std::uint8_t* below, std::uint8_t* digits, int begin, int numCols)
+{
+    for(int col=begin; col<numCols; ++col)
+    {
+        const int sum = above[col] + above[col+1] + above[col+2]
+                      + row[col] + row[col+2]
+                      + below[col] + below[col+1] + below[col+2];
+        digits[col] = row[col+1] ? 0 : sum;
+    }
+}
+
+#ifdef KMINES_X86_KERNELS
+
+__attribute__((target("sse2")))
+static inline __m128i loadSse2(const std::uint8_t* p)
+{
+    return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i loadAvx2(const std::uint8_t* p)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+__attribute__((target("sse2")))
+static void countSse2(const std::uint8_t* above, const std::uint8_t* row,
+                      const std::uint8_t* below, std::uint8_t* digits, int numCols)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int col = 0;
+    for(; col + 16 <= numCols; col += 16)
+    {
+        __m128i sum = _mm_add_epi8(loadSse2(above+col), loadSse2(above+col+1));
+        sum = _mm_add_epi8(sum, loadSse2(above+col+2));
+        sum = _mm_add_epi8(sum, loadSse2(row+col));
+        sum = _mm_add_epi8(sum, loadSse2(row+col+2));
+        sum = _mm_add_epi8(sum, loadSse2(below+col));
+        sum = _mm_add_epi8(sum, loadSse2(below+col+1));
+        sum = _mm_add_epi8(sum, loadSse2(below+col+2));
+        const __m128i noMine = _mm_cmpeq_epi8(loadSse2(row+col+1), zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(digits+col), _mm_and_si128(sum, noMine));
+    }
+    countScalar(above, row, below, digits, col, numCols);
+}
+
+__attribute__((target("avx2")))
+static void countAvx2(const std::uint8_t* above, const std::uint8_t* row,
+                      const std::uint8_t* below, std::uint8_t* digits, int numCols)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    int col = 0;
+    for(; col + 32 <= numCols; col += 32)
+    {
+        __m256i sum = _mm256_add_epi8(loadAvx2(above+col), loadAvx2(above+col+1));
+        sum = _mm256_add_epi8(sum, loadAvx2(above+col+2));
+        sum = _mm256_add_epi8(sum, loadAvx2(row+col));
+        sum = _mm256_add_epi8(sum, loadAvx2(row+col+2));
+        sum = _mm256_add_epi8(sum, loadAvx2(below+col));
+        sum = _mm256_add_epi8(sum, loadAvx2(below+col+1));
+        sum = _mm256_add_epi8(sum, loadAvx2(below+col+2));
+        const __m256i noMine = _mm256_cmpeq_epi8(loadAvx2(row+col+1), zero);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(digits+col), _mm256_and_si256(sum, noMine));
+    }
+    countSse2(above + col, row + col, below + col, digits + col, numCols - col);
+}
+
+#endif
+
+using CountFunction = void (*)(const std::uint8_t*, const std::uint8_t*,
+                               const std::uint8_t*, std::uint8_t*, int);
+
+static CountFunction selectCountFunction()
+{
+#ifdef KMINES_X86_KERNELS
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx2"))
+        return countAvx2;
+    if(__builtin_cpu_supports("sse2"))
+        return countSse2;
+#endif
+    return [](const std::uint8_t* above, const std::uint8_t* row,
+              const std::uint8_t* below, std::uint8_t* digits, int numCols) {
+        countScalar(above, row, below, digits, 0, numCols);
+    };
+}
+
+void KMinesKernels::countNeighbourMines(const std::uint8_t* above, const std::uint8_t* row,
+                                        const std::uint8_t* below, std::uint8_t* digits, int numCols)
+{
+    static const CountFunction count = selectCountFunction();
+    count(above, row, below, digits, numCols);
+}
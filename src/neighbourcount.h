@@ -0,0 +1,32 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef NEIGHBOURCOUNT_H
+#define NEIGHBOURCOUNT_H
+
+// Std
+#include <cstdint>
+
+namespace KMinesKernels
+{
+    /**
+     * Computes digits of one field row from mine flags of the row and
+     * the rows above and below it.
+     *
+     * Input rows hold one byte per cell (1 for a mine, 0 otherwise) and are
+     * padded with a zero byte on each side, i.e. have numCols+2 bytes and
+     * cell col is at index col+1. Use a zeroed row for missing neighbours.
+     *
+     * digits[col] gets the number of mines around the cell, or 0 if the
+     * cell itself holds a mine.
+     *
+     * Uses AVX2 or SSE2 if the CPU supports them, chosen at runtime.
+     */
+    void countNeighbourMines(const std::uint8_t* above, const std::uint8_t* row,
+                             const std::uint8_t* below, std::uint8_t* digits, int numCols);
+}
+
+#endif
@@ -0,0 +1,23 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef RENDERSTATS_H
+#define RENDERSTATS_H
+
+/**
+ * Counters for profiling theme rendering
+ */
+namespace KMinesRenderStats
+{
+/**
+ * Number of sprite pixmaps requested from KGameRenderer for a new
+ * size. Each one is an SVG rasterization unless the renderer had it
+ * cached already
+ */
+inline int spriteRenders = 0;
+}
+
+#endif
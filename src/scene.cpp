@@ -8,42 +8,148 @@
 #include "scene.h"
 
 // own
+#include "kmines_debug.h"
 #include "settings.h"
 #include "minefielditem.h"
+#include "renderstats.h"
+#include "startupprofile.h"
 // KDEGames
 #include <KGamePopupItem>
+#include <KGameTheme>
 #include <KGameThemeProvider>
 // KF
+#include <KConfigGroup>
 #include <KLocalizedString>
+#include <KSharedConfig>
 // Qt
+#include <QDir>
+#include <QElapsedTimer>
+#include <QPainter>
 #include <QResizeEvent>
+#include <QStandardPaths>
+#include <QWindow>
 
 // --------------- KMinesView ---------------
 
 KMinesView::KMinesView( KMinesScene* scene, QWidget *parent )
     : QGraphicsView(scene, parent), m_scene(scene)
 {
+    // the ratio of the screen the window will likely be shown on, so
+    // that the first sprites are rendered for it
+    updateDevicePixelRatio();
 }
 
 void KMinesView::resizeEvent( QResizeEvent *ev )
 {
-    m_scene->resizeScene( ev->size().width(), ev->size().height() );
+    updateDevicePixelRatio();
+    m_scene->resizeSceneLater( ev->size().width(), ev->size().height() );
+}
+
+void KMinesView::showEvent( QShowEvent *ev )
+{
+    QGraphicsView::showEvent(ev);
+    // the window handle exists once shown
+    QWindow* handle = window()->windowHandle();
+    if(handle && !m_screenConnection)
+        m_screenConnection = connect(handle, &QWindow::screenChanged, this, &KMinesView::updateDevicePixelRatio);
+    updateDevicePixelRatio();
+}
+
+void KMinesView::updateDevicePixelRatio()
+{
+    m_scene->setDevicePixelRatio(devicePixelRatioF());
+}
+
+void KMinesView::paintEvent( QPaintEvent *ev )
+{
+    QElapsedTimer timer;
+    timer.start();
+    QGraphicsView::paintEvent(ev);
+    qCDebug(KMINES_LOG) << "Frame painted in" << timer.nsecsElapsed() / 1000 << "us,"
+                        << m_scene->items().size() << "scene items";
+
+    if(!m_firstFrameLogged)
+    {
+        // the game takes input from here on
+        m_firstFrameLogged = true;
+        StartupProfile::mark("first frame");
+    }
+    if(!m_spritesReadyLogged && m_scene->spritesReady())
+    {
+        m_spritesReadyLogged = true;
+        StartupProfile::mark("first frame without placeholders");
+    }
 }
 
 // -------------- KMinesScene --------------------
 
+/**
+ * Adds the themes installed in the themes directories to prov, except
+ * those it has already. If identifier is given, only that theme
+ */
+static void addThemes(KGameThemeProvider* prov, const QByteArray& identifier = QByteArray())
+{
+    QList<QByteArray> known;
+    const QList<const KGameTheme*> themes = prov->themes();
+    for (const KGameTheme* theme : themes) {
+        known << theme->identifier();
+    }
+
+    const QStringList dirs = QStandardPaths::locateAll(QStandardPaths::AppDataLocation, QStringLiteral("themes"),
+                                                       QStandardPaths::LocateDirectory);
+    for (const QString& dir : dirs) {
+        const QFileInfoList files = QDir(dir).entryInfoList({ QStringLiteral("*.desktop") }, QDir::Files);
+        for (const QFileInfo& file : files) {
+            // same identifiers as KGameThemeProvider::discoverThemes() uses
+            const QByteArray themeIdentifier = file.completeBaseName().toUtf8();
+            if(known.contains(themeIdentifier) || (!identifier.isEmpty() && themeIdentifier != identifier))
+                continue;
+            auto* theme = new KGameTheme(themeIdentifier);
+            if(!theme->readFromDesktopFile(file.absoluteFilePath()))
+            {
+                delete theme;
+                continue;
+            }
+            known << themeIdentifier;
+            prov->addTheme(theme);
+        }
+    }
+}
+
 static KGameThemeProvider* provider()
 {
     auto* prov = new KGameThemeProvider;
-    prov->discoverThemes(QStringLiteral("themes"));
+    // only the theme in use is needed for the first frame, the others
+    // are added by KMinesScene::discoverAllThemes()
+    const KConfigGroup group(KSharedConfig::openConfig(), QStringLiteral("KgTheme"));
+    addThemes(prov, group.readEntry("Theme", QByteArray("default")));
+    if(prov->themes().isEmpty())
+        addThemes(prov, QByteArray("default"));
+    if(prov->themes().isEmpty())
+        addThemes(prov);
+    StartupProfile::mark("theme found");
 
     return prov;
 }
 
 KMinesScene::KMinesScene( QObject* parent )
-    : QGraphicsScene(parent), m_renderer(provider())
+    : QGraphicsScene(parent), m_renderer(provider()),
+      m_backgroundSprite(&m_renderer, QStringLiteral( "mainWidget" ), [this] { onBackgroundReady(); })
 {
     setItemIndexMethod( NoIndex );
+    // all sprites are requested through SpriteClient, none of them
+    // should be rendered on the GUI thread
+    m_renderer.setStrategyEnabled(KGameRenderer::UseRenderingThreads, true);
+    m_spriteCache.setBudget(qint64(Settings::spriteCacheBudget()) * 1024 * 1024);
+    m_spriteCache.setRendererTheme(m_renderer.themeProvider()->currentTheme()->graphicsPath());
+    connect(&m_renderer, &KGameRenderer::themeChanged, this, [this] {
+        m_spriteCache.setRendererTheme(m_renderer.themeProvider()->currentTheme()->graphicsPath());
+    });
+    m_resizeTimer.setSingleShot(true);
+    m_resizeTimer.setInterval(ResizeIdleTime);
+    connect(&m_resizeTimer, &QTimer::timeout, this, [this] {
+        resizeScene((int)sceneRect().width(), (int)sceneRect().height());
+    });
     m_fieldItem = new MineFieldItem(&m_renderer);
     connect(m_fieldItem, &MineFieldItem::flaggedMinesCountChanged, this, &KMinesScene::minesCountChanged);
     connect(m_fieldItem, &MineFieldItem::firstClickDone, this, &KMinesScene::firstClickDone);
@@ -51,6 +157,7 @@ KMinesScene::KMinesScene( QObject* parent )
     // and re-emit it for others
     connect(m_fieldItem, &MineFieldItem::gameOver, this, &KMinesScene::gameOver);
     addItem(m_fieldItem);
+    m_fieldItem->setBatchedRendering(Settings::batchedRendering());
 
     m_messageItem = new KGamePopupItem;
     m_messageItem->setMessageOpacity(0.9);
@@ -62,8 +169,21 @@ KMinesScene::KMinesScene( QObject* parent )
     m_gamePausedMessageItem->setMessageTimeout(0);
     m_gamePausedMessageItem->setHideOnMouseClick(false);
     addItem(m_gamePausedMessageItem);
-    
-    setBackgroundBrush(m_renderer.spritePixmap(QStringLiteral( "mainWidget" ), sceneRect().size().toSize()));
+}
+
+KMinesScene::~KMinesScene()
+{
+    // its sprite clients need m_renderer and m_spriteCache, which are
+    // gone by the time QGraphicsScene deletes the items
+    delete m_fieldItem;
+}
+
+void KMinesScene::discoverAllThemes()
+{
+    if(m_allThemesDiscovered)
+        return;
+    m_allThemesDiscovered = true;
+    addThemes(m_renderer.themeProvider());
 }
 
 void KMinesScene::reset()
@@ -72,6 +192,17 @@ void KMinesScene::reset()
     m_messageItem->forceHide();
 }
 
+void KMinesScene::setBatchedRendering(bool batched)
+{
+    m_fieldItem->setBatchedRendering(batched);
+}
+
+void KMinesScene::setSpriteCacheBudget(int megabytes)
+{
+    m_spriteCache.setBudget(qint64(megabytes) * 1024 * 1024);
+    m_spriteCache.logStats("after budget change");
+}
+
 bool KMinesScene::canScore() const
 {
     return m_canScore;
@@ -82,13 +213,117 @@ void KMinesScene::setCanScore(bool value)
     m_canScore = value;
 }
 
+void KMinesScene::setDevicePixelRatio(qreal dpr)
+{
+    if(dpr <= 0 || dpr == m_dpr)
+        return;
+    qCDebug(KMINES_LOG) << "Device pixel ratio" << m_dpr << "->" << dpr;
+    m_dpr = dpr;
+    const int rendersBefore = KMinesRenderStats::spriteRenders;
+    updateBackground();
+    m_fieldItem->setDevicePixelRatio(dpr);
+    qCDebug(KMINES_LOG) << "Sprite renders for the new ratio:" << KMinesRenderStats::spriteRenders - rendersBefore;
+    m_spriteCache.logStats("after device pixel ratio change");
+}
+
 void KMinesScene::resizeScene(int width, int height)
 {
+    // a pending deferred resize is done by this one
+    m_resizeTimer.stop();
+
     setSceneRect(0, 0, width, height);
-    setBackgroundBrush(m_renderer.spritePixmap(QStringLiteral( "mainWidget" ), sceneRect().size().toSize()));
+    updateBackground();
+    invalidate(sceneRect(), BackgroundLayer);
     m_fieldItem->resizeToFitInRect( sceneRect() );
-    m_fieldItem->setPos( sceneRect().width()/2 - m_fieldItem->boundingRect().width()/2,
-                         sceneRect().height()/2 - m_fieldItem->boundingRect().height()/2 );
+    positionMessages();
+
+    if(m_resizeSteps != 0)
+    {
+        qCDebug(KMINES_LOG) << "Resize gesture:" << m_resizeSteps << "resize events,"
+                            << KMinesRenderStats::spriteRenders - m_rendersAtResizeStart << "sprite renders";
+        m_spriteCache.logStats("after resize");
+        m_resizeSteps = 0;
+    }
+}
+
+void KMinesScene::resizeSceneLater(int width, int height)
+{
+    if(sceneRect().isEmpty() || width <= 0 || height <= 0)
+    {
+        // nothing rendered yet to scale from
+        resizeScene(width, height);
+        return;
+    }
+
+    if(m_resizeSteps == 0)
+        m_rendersAtResizeStart = KMinesRenderStats::spriteRenders;
+    m_resizeSteps++;
+
+    setSceneRect(0, 0, width, height);
+    // the last picked background gets stretched over the new size
+    invalidate(sceneRect(), BackgroundLayer);
+    m_fieldItem->resizeToFitInRect( sceneRect(), true );
+    positionMessages();
+
+    m_resizeTimer.start();
+}
+
+QSize KMinesScene::backgroundBucket(const QSize& size)
+{
+    return QSize((size.width() + BackgroundBucket - 1) / BackgroundBucket * BackgroundBucket,
+                 (size.height() + BackgroundBucket - 1) / BackgroundBucket * BackgroundBucket);
+}
+
+void KMinesScene::updateBackground()
+{
+    const QSize bucket = backgroundBucket(sceneRect().size().toSize());
+    // delivered right away if it is cached
+    if(!bucket.isEmpty())
+        m_backgroundSprite.setRenderSize(bucket, m_dpr);
+}
+
+void KMinesScene::onBackgroundReady()
+{
+    const QPixmap pixmap = m_backgroundSprite.pixmap();
+    if(!m_backgroundSprite.isReady())
+    {
+        // a scaled stand-in from the atlas, only better than nothing
+        if(m_background.isNull() && !pixmap.isNull())
+        {
+            m_background = pixmap;
+            invalidate(sceneRect(), BackgroundLayer);
+        }
+        return;
+    }
+    m_background = pixmap;
+    invalidate(sceneRect(), BackgroundLayer);
+}
+
+bool KMinesScene::spritesReady() const
+{
+    return m_backgroundSprite.isReady()
+        && m_backgroundSprite.renderSize() == backgroundBucket(sceneRect().size().toSize())
+        && m_backgroundSprite.devicePixelRatio() == m_dpr
+        && m_fieldItem->spritesReady();
+}
+
+void KMinesScene::drawBackground(QPainter* painter, const QRectF& rect)
+{
+    const QRectF exposed = rect.intersected(sceneRect());
+    if(m_background.isNull() || exposed.isEmpty())
+        return;
+
+    // only the exposed part, mapped to the pixmap's device pixels
+    const qreal scaleX = m_background.width() / sceneRect().width();
+    const qreal scaleY = m_background.height() / sceneRect().height();
+    const QRectF source(exposed.x() * scaleX, exposed.y() * scaleY,
+                        exposed.width() * scaleX, exposed.height() * scaleY);
+    painter->setRenderHint(QPainter::SmoothPixmapTransform);
+    painter->drawPixmap(exposed, m_background, source);
+}
+
+void KMinesScene::positionMessages()
+{
     m_gamePausedMessageItem->setPos( sceneRect().width()/2 - m_gamePausedMessageItem->boundingRect().width()/2,
                           sceneRect().height()/2 - m_gamePausedMessageItem->boundingRect().height()/2 );
     m_messageItem->setPos( sceneRect().width()/2 - m_messageItem->boundingRect().width()/2,
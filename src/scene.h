@@ -8,11 +8,17 @@
 #ifndef SCENE_H
 #define SCENE_H
 
+// own
+#include "spritecache.h"
+#include "spriteclient.h"
+#include "themeswitch.h"
 // KDEGames
 #include <KGameRenderer>
 // Qt
 #include <QGraphicsView>
 #include <QGraphicsScene>
+#include <QPixmap>
+#include <QTimer>
 
 class MineFieldItem;
 class KGamePopupItem;
@@ -28,10 +34,31 @@ public:
      * Constructs scene
      */
     explicit KMinesScene( QObject* parent );
+    ~KMinesScene() override;
     /**
      * Resizes scene to given dimensions
      */
     void resizeScene(int width, int height);
+    /**
+     * Resizes scene to given dimensions without rendering anything:
+     * the background and the field are scaled from the last rendered
+     * size. The scene gets rendered for the new size by resizeScene()
+     * once no resize happened for ResizeIdleTime ms.
+     *
+     * Meant for the stream of resize events while the window is resized
+     */
+    void resizeSceneLater(int width, int height);
+    /**
+     * Time in ms the size has to stay unchanged before a deferred
+     * resize renders the scene
+     */
+    static const int ResizeIdleTime = 150;
+    /**
+     * The background is rendered for window sizes rounded up to
+     * multiples of this many pixels
+     */
+    static const int BackgroundBucket = 128;
+
     /**
      * @return total number of mines in field
      */
@@ -48,6 +75,32 @@ public:
      * Resets the scene
      */
     void reset();
+    /**
+     * Adds all installed themes to the renderer's theme provider. Only
+     * the theme in use is loaded at startup; this has to be called
+     * before the themes are listed
+     */
+    void discoverAllThemes();
+    /**
+     * See MineFieldItem::setBatchedRendering()
+     */
+    void setBatchedRendering(bool batched);
+    /**
+     * Sets the budget of the SpriteCache
+     */
+    void setSpriteCacheBudget(int megabytes);
+    /**
+     * Sets device pixel ratio of the screen the scene is shown on.
+     * Sprites are rendered for it and cached per ratio, so moving back
+     * to a screen shown on before re-renders nothing
+     */
+    void setDevicePixelRatio(qreal dpr);
+
+    /**
+     * @return true if the background and all field sprites are rendered
+     * for the current size, i.e. no placeholders are shown
+     */
+    bool spritesReady() const;
 
     KGameRenderer& renderer() {return m_renderer;}
     /**
@@ -63,8 +116,61 @@ Q_SIGNALS:
 private Q_SLOTS:
     void onGameOver(bool);
 private:
+    /**
+     * Draws the background pixmap stretched over the scene
+     */
+    void drawBackground(QPainter* painter, const QRectF& rect) override;
+    /**
+     * @return size the background is rendered at for a window of given size
+     */
+    static QSize backgroundBucket(const QSize& size);
+    /**
+     * Picks the background for the current scene size from the cache,
+     * or requests it from the renderer. Until it arrives, the current
+     * background gets stretched
+     */
+    void updateBackground();
+    void onBackgroundReady();
+    /**
+     * Centers the message items in the scene
+     */
+    void positionMessages();
+
     bool m_canScore;
+    bool m_allThemesDiscovered = false;
+    qreal m_dpr = 1.0;
+    /**
+     * Sprites of all sizes rendered during the session, constructed
+     * before and destroyed after all SpriteClients of the scene
+     */
+    SpriteCache m_spriteCache;
+    /**
+     * Swaps in a new theme once all its sprites are rendered, also
+     * outlives all SpriteClients of the scene
+     */
+    ThemeSwitch m_themeSwitch;
     KGameRenderer m_renderer;
+    /**
+     * Background drawn in drawBackground()
+     */
+    QPixmap m_background;
+    /**
+     * Renders background buckets off the GUI thread
+     */
+    SpriteClient m_backgroundSprite;
+
+    /**
+     * Fires resizeScene() at the end of a resize gesture
+     */
+    QTimer m_resizeTimer;
+    /**
+     * Number of resizeSceneLater() calls in the current gesture
+     */
+    int m_resizeSteps = 0;
+    /**
+     * KMinesRenderStats::spriteRenders at the start of the current gesture
+     */
+    int m_rendersAtResizeStart = 0;
     /**
      * Game field graphics item
      */
@@ -82,7 +188,21 @@ public:
     KMinesView( KMinesScene* scene, QWidget *parent );
 private:
     void resizeEvent( QResizeEvent *ev ) override;
+    /**
+     * Reimplemented to follow the device pixel ratio of the screen the
+     * window is on
+     */
+    void showEvent( QShowEvent *ev ) override;
+    void updateDevicePixelRatio();
+    /**
+     * Reimplemented to log frame times, and the time from startup to
+     * the first frame and to the first frame without placeholders
+     */
+    void paintEvent( QPaintEvent *ev ) override;
 
     KMinesScene* m_scene = nullptr;
+    bool m_firstFrameLogged = false;
+    bool m_spritesReadyLogged = false;
+    QMetaObject::Connection m_screenConnection;
 };
 #endif
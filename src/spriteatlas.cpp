@@ -0,0 +1,139 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "spriteatlas.h"
+
+// own
+#include "kmines_debug.h"
+// Qt
+#include <QImage>
+// Std
+#include <cstring>
+#include <memory>
+
+const SpriteAtlas* SpriteAtlas::forTheme(const QString& graphicsPath)
+{
+    static QHash<QString, std::shared_ptr<SpriteAtlas>> s_atlases;
+    auto it = s_atlases.constFind(graphicsPath);
+    if(it == s_atlases.constEnd())
+    {
+        std::shared_ptr<SpriteAtlas> atlas(new SpriteAtlas(atlasPath(graphicsPath)));
+        if(!atlas->isValid())
+            atlas.reset();
+        it = s_atlases.insert(graphicsPath, atlas);
+    }
+    return it.value().get();
+}
+
+QString SpriteAtlas::atlasPath(const QString& graphicsPath)
+{
+    QString path = graphicsPath;
+    if(path.endsWith(QLatin1String(".svgz")))
+        path.chop(5);
+    else if(path.endsWith(QLatin1String(".svg")))
+        path.chop(4);
+    return path + QLatin1String(".katlas");
+}
+
+SpriteAtlas::SpriteAtlas(const QString& path)
+    : m_file(path)
+{
+    if(!m_file.exists() || !m_file.open(QIODevice::ReadOnly))
+        return;
+
+    const qint64 size = m_file.size();
+    const uchar* data = m_file.map(0, size);
+    if(!data || size < qint64(sizeof(FileHeader)))
+        return;
+
+    FileHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if(std::memcmp(header.magic, "KMAT", 4) != 0 || header.byteOrderMark != ByteOrderMark
+       || header.version != FileVersion)
+    {
+        qCWarning(KMINES_LOG) << "Ignoring incompatible sprite atlas" << path;
+        return;
+    }
+    const qint64 tableSize = sizeof(FileHeader) + qint64(header.pageCount) * sizeof(FilePage)
+                             + qint64(header.spriteCount) * sizeof(FileSprite);
+    if(tableSize > size)
+        return;
+
+    const uchar* pos = data + sizeof(FileHeader);
+    for(quint32 i=0; i<header.pageCount; ++i, pos += sizeof(FilePage))
+    {
+        FilePage page;
+        std::memcpy(&page, pos, sizeof(page));
+        if(page.offset % 4 != 0 || page.offset + quint64(page.width) * page.height * 4 > quint64(size))
+            return;
+        m_pages.append(page);
+    }
+    for(quint32 i=0; i<header.spriteCount; ++i, pos += sizeof(FileSprite))
+    {
+        FileSprite sprite;
+        std::memcpy(&sprite, pos, sizeof(sprite));
+        sprite.key[sizeof(sprite.key)-1] = '\0';
+        if(sprite.page >= quint32(m_pages.size()))
+            return;
+        const QRect rect(sprite.x, sprite.y, sprite.width, sprite.height);
+        const FilePage& page = m_pages[sprite.page];
+        if(!QRect(0, 0, page.width, page.height).contains(rect))
+            return;
+        m_sprites[QString::fromLatin1(sprite.key)].append({ static_cast<int>(sprite.page), rect });
+    }
+
+    m_data = data;
+    qCDebug(KMINES_LOG) << "Sprite atlas" << path << "with" << m_pages.size() << "pages";
+}
+
+QPixmap SpriteAtlas::pixmap(const QString& key, const QSize& size) const
+{
+    const QList<Sprite> sprites = m_sprites.value(key);
+    for (const Sprite& sprite : sprites) {
+        if(sprite.rect.size() == size)
+            return copySprite(sprite.page, sprite.rect);
+    }
+    return QPixmap();
+}
+
+QPixmap SpriteAtlas::nearestPixmap(const QString& key, const QSize& size) const
+{
+    // scaling down looks better than scaling up, so the smallest sprite
+    // at least as large as size wins, else the largest smaller one
+    const QList<Sprite> sprites = m_sprites.value(key);
+    const Sprite* nearest = nullptr;
+    for (const Sprite& sprite : sprites) {
+        const QSize spriteSize = sprite.rect.size();
+        const bool covers = spriteSize.width() >= size.width() && spriteSize.height() >= size.height();
+        if(!nearest)
+        {
+            nearest = &sprite;
+            continue;
+        }
+        const QSize nearestSize = nearest->rect.size();
+        const bool nearestCovers = nearestSize.width() >= size.width() && nearestSize.height() >= size.height();
+        const qint64 area = qint64(spriteSize.width()) * spriteSize.height();
+        const qint64 nearestArea = qint64(nearestSize.width()) * nearestSize.height();
+        bool better = covers;
+        if(covers == nearestCovers)
+            better = covers ? area < nearestArea : area > nearestArea;
+        if(better)
+            nearest = &sprite;
+    }
+    return nearest ? copySprite(nearest->page, nearest->rect) : QPixmap();
+}
+
+QPixmap SpriteAtlas::copySprite(int page, const QRect& rect) const
+{
+    const FilePage& p = m_pages[page];
+    // wraps the mapped pixels of just the sprite, so the only copy is
+    // the one into the pixmap. The mapping stays valid as atlases are
+    // never closed
+    const qsizetype stride = qsizetype(p.width) * 4;
+    const uchar* bits = m_data + p.offset + rect.y() * stride + rect.x() * 4;
+    const QImage image(bits, rect.width(), rect.height(), stride, QImage::Format_ARGB32_Premultiplied);
+    return QPixmap::fromImage(image);
+}
@@ -0,0 +1,137 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SPRITEATLAS_H
+#define SPRITEATLAS_H
+
+// Qt
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QRect>
+#include <QStringList>
+
+/**
+ * Sprites of a theme prerendered at build time by kmines_atlasgen,
+ * so that they don't have to be rendered from the SVG at runtime.
+ *
+ * The atlas is a file installed next to the theme's SVG. It holds
+ * pages of uncompressed ARGB32 premultiplied pixels, which are used
+ * straight from the memory-mapped file: only the sprites which get
+ * looked up are read from disk.
+ *
+ * Cell and border sprites are stored at a few standard cell sizes,
+ * the background at one size. Cells fitted into a window rarely have
+ * one of these sizes exactly: then the nearest sprite, scaled to the
+ * cell size, stands in until the renderer delivers the exact size.
+ * So the atlas makes the first frame fast at any size, while exact
+ * hits mostly help with the default window size.
+ */
+class SpriteAtlas
+{
+public:
+    /**
+     * @return atlas of the theme with given SVG file, or nullptr if
+     * it has none. Atlases are opened once and kept open
+     */
+    static const SpriteAtlas* forTheme(const QString& graphicsPath);
+    /**
+     * @return path of the atlas belonging to an SVG file
+     */
+    static QString atlasPath(const QString& graphicsPath);
+    /**
+     * @return sprite rendered at exactly size, or a null pixmap
+     */
+    QPixmap pixmap(const QString& key, const QSize& size) const;
+    /**
+     * @return sprite rendered at the smallest size covering size, or at
+     * the largest size if none does, or a null pixmap if the atlas
+     * doesn't have the sprite at all
+     */
+    QPixmap nearestPixmap(const QString& key, const QSize& size) const;
+
+    /**
+     * Sprites prerendered at cell sizes: all that cells and the
+     * border are made of
+     */
+    static QStringList cellSprites()
+    {
+        return QStringList{
+            QStringLiteral( "cell_up" ), QStringLiteral( "cell_down" ),
+            QStringLiteral( "flag" ), QStringLiteral( "question" ), QStringLiteral( "hint" ),
+            QStringLiteral( "mine" ), QStringLiteral( "explosion" ), QStringLiteral( "error" ),
+            QStringLiteral( "arabicOne" ), QStringLiteral( "arabicTwo" ),
+            QStringLiteral( "arabicThree" ), QStringLiteral( "arabicFour" ),
+            QStringLiteral( "arabicFive" ), QStringLiteral( "arabicSix" ),
+            QStringLiteral( "arabicSeven" ), QStringLiteral( "arabicEight" ),
+            QStringLiteral( "border.edge.north" ), QStringLiteral( "border.edge.south" ),
+            QStringLiteral( "border.edge.east" ), QStringLiteral( "border.edge.west" ),
+            QStringLiteral( "border.outsideCorner.ne" ), QStringLiteral( "border.outsideCorner.nw" ),
+            QStringLiteral( "border.outsideCorner.se" ), QStringLiteral( "border.outsideCorner.sw" )
+        };
+    }
+    /**
+     * Sprite prerendered at a single size, scaled to the window at runtime
+     */
+    static QString backgroundSprite() { return QStringLiteral( "mainWidget" ); }
+
+    // file format, all integers in the byte order of the build host
+
+    static const quint32 FileVersion = 1;
+    static const quint32 ByteOrderMark = 0x01020304;
+    struct FileHeader
+    {
+        char magic[4]; // "KMAT"
+        quint32 byteOrderMark;
+        quint32 version;
+        quint32 pageCount;
+        quint32 spriteCount;
+        quint32 reserved[3];
+    };
+    /**
+     * Follow the header, pageCount times. Pixels are at offset from the
+     * start of the file, width*4 bytes per line
+     */
+    struct FilePage
+    {
+        quint64 offset;
+        quint32 width;
+        quint32 height;
+    };
+    /**
+     * Follows the pages, spriteCount times
+     */
+    struct FileSprite
+    {
+        char key[48]; // null terminated
+        quint32 page;
+        quint32 x;
+        quint32 y;
+        quint32 width;
+        quint32 height;
+        quint32 reserved[3];
+    };
+private:
+    explicit SpriteAtlas(const QString& path);
+    bool isValid() const { return m_data != nullptr; }
+    QPixmap copySprite(int page, const QRect& rect) const;
+
+    struct Sprite
+    {
+        int page;
+        QRect rect;
+    };
+    QFile m_file;
+    const uchar* m_data = nullptr;
+    QList<FilePage> m_pages;
+    /**
+     * All sizes of each sprite
+     */
+    QHash<QString, QList<Sprite>> m_sprites;
+};
+
+#endif
@@ -0,0 +1,218 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "spritecache.h"
+
+// own
+#include "kmines_debug.h"
+
+// Std
+#include <iterator>
+
+SpriteCache* SpriteCache::s_instance = nullptr;
+
+size_t qHash(const SpriteCache::Key& key, size_t seed)
+{
+    return qHashMulti(seed, key.theme, key.sprite, key.size.width(), key.size.height(), key.dpr);
+}
+
+size_t qHash(const SpriteCache::GroupKey& key, size_t seed)
+{
+    return qHashMulti(seed, key.theme, key.sprite, key.dpr);
+}
+
+SpriteCache::SpriteCache()
+{
+    s_instance = this;
+}
+
+SpriteCache::~SpriteCache()
+{
+    s_instance = nullptr;
+}
+
+void SpriteCache::setBudget(qint64 bytes)
+{
+    m_budget = bytes;
+    evict();
+}
+
+QPixmap SpriteCache::find(const QString& theme, const QString& sprite, const QSize& size, qreal dpr)
+{
+    auto it = m_entries.find({ theme, sprite, size, dpr });
+    if(it == m_entries.end())
+    {
+        m_stats.misses++;
+        return QPixmap();
+    }
+    m_stats.hits++;
+    it->lastUse = ++m_useClock;
+    return it->pixmap;
+}
+
+void SpriteCache::insert(const QString& theme, const QString& sprite, const QSize& size, qreal dpr, const QPixmap& pixmap)
+{
+    const Key key{ theme, sprite, size, dpr };
+    const qint64 bytes = qint64(pixmap.width()) * pixmap.height() * pixmap.depth() / 8;
+    auto it = m_entries.find(key);
+    if(it != m_entries.end())
+    {
+        account(key, it->bytes, -1);
+        *it = { pixmap, bytes, ++m_useClock };
+    }
+    else
+    {
+        m_entries.insert(key, { pixmap, bytes, ++m_useClock });
+        addArea(m_groups[groupKey(key)].cachedAreas, area(size));
+        m_stats.entries++;
+    }
+    account(key, bytes, 1);
+    evict();
+}
+
+void SpriteCache::acquire(const QString& theme, const QString& sprite, const QSize& size, qreal dpr)
+{
+    const Key key{ theme, sprite, size, dpr };
+    if(m_useCounts[key]++ > 0)
+        return;
+    addArea(m_groups[groupKey(key)].usedAreas, area(size));
+    auto it = m_entries.constFind(key);
+    if(it != m_entries.constEnd() && !isShared(key))
+        m_evictableBytes -= it->bytes;
+}
+
+void SpriteCache::release(const QString& theme, const QString& sprite, const QSize& size, qreal dpr)
+{
+    const Key key{ theme, sprite, size, dpr };
+    auto used = m_useCounts.find(key);
+    if(used == m_useCounts.end() || --used.value() > 0)
+        return;
+    m_useCounts.erase(used);
+
+    auto group = m_groups.find(groupKey(key));
+    removeArea(group->usedAreas, area(size));
+    if(group->usedAreas.isEmpty() && group->cachedAreas.isEmpty())
+        m_groups.erase(group);
+    auto it = m_entries.constFind(key);
+    if(it != m_entries.constEnd() && !isShared(key))
+        m_evictableBytes += it->bytes;
+    // a budget exceeded by pixmaps in use is enforced once they are not
+    evict();
+}
+
+void SpriteCache::evict()
+{
+    // pixmaps in use alone may exceed the budget, then there is nothing to do
+    while(m_stats.residentBytes > m_budget && m_evictableBytes > 0)
+    {
+        auto victim = m_entries.end();
+        bool victimNextToUsed = false;
+        for(auto it = m_entries.begin(); it != m_entries.end(); ++it)
+        {
+            if(isShared(it.key()) || m_useCounts.contains(it.key()))
+                continue;
+            const bool nextToUsed = isNextToUsedSize(it.key());
+            if(victim == m_entries.end() || (victimNextToUsed && !nextToUsed)
+               || (victimNextToUsed == nextToUsed && it->lastUse < victim->lastUse))
+            {
+                victim = it;
+                victimNextToUsed = nextToUsed;
+            }
+        }
+        if(victim == m_entries.end())
+            return;
+
+        m_stats.evictions++;
+        removeEntry(victim);
+    }
+}
+
+void SpriteCache::setRendererTheme(const QString& theme)
+{
+    if(theme == m_rendererTheme)
+        return;
+    for(auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+        account(it.key(), it->bytes, -1);
+    m_rendererTheme = theme;
+    for(auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+        account(it.key(), it->bytes, 1);
+    evict();
+}
+
+void SpriteCache::account(const Key& key, qint64 bytes, int sign)
+{
+    if(isShared(key))
+    {
+        m_stats.sharedBytes += sign * bytes;
+        return;
+    }
+    m_stats.residentBytes += sign * bytes;
+    if(!m_useCounts.contains(key))
+        m_evictableBytes += sign * bytes;
+}
+
+void SpriteCache::removeEntry(QHash<Key, Entry>::iterator it)
+{
+    auto group = m_groups.find(groupKey(it.key()));
+    removeArea(group->cachedAreas, area(it.key().size));
+    if(group->usedAreas.isEmpty() && group->cachedAreas.isEmpty())
+        m_groups.erase(group);
+    account(it.key(), it->bytes, -1);
+    m_stats.entries--;
+    m_entries.erase(it);
+}
+
+void SpriteCache::addArea(QMap<qint64, int>& areas, qint64 area)
+{
+    areas[area]++;
+}
+
+void SpriteCache::removeArea(QMap<qint64, int>& areas, qint64 area)
+{
+    auto it = areas.find(area);
+    if(--it.value() == 0)
+        areas.erase(it);
+}
+
+bool SpriteCache::isNextToUsedSize(const Key& key) const
+{
+    const auto group = m_groups.constFind(groupKey(key));
+    if(group == m_groups.constEnd() || group->usedAreas.isEmpty())
+        return false;
+    const QMap<qint64, int>& used = group->usedAreas;
+    const QMap<qint64, int>& cached = group->cachedAreas;
+    const qint64 keyArea = area(key.size);
+
+    // neighbours have no other cached size in between. It's enough to
+    // look at the nearest used size above and below
+    auto above = used.lowerBound(keyArea);
+    if(above != used.constEnd())
+    {
+        if(above.key() == keyArea)
+            return true;
+        auto next = cached.upperBound(keyArea);
+        if(next == cached.constEnd() || next.key() >= above.key())
+            return true;
+    }
+    if(above != used.constBegin())
+    {
+        const qint64 below = std::prev(above).key();
+        auto previous = cached.lowerBound(keyArea);
+        if(previous == cached.constBegin() || std::prev(previous).key() <= below)
+            return true;
+    }
+    return false;
+}
+
+void SpriteCache::logStats(const char* context) const
+{
+    const qint64 lookups = m_stats.hits + m_stats.misses;
+    qCDebug(KMINES_LOG) << "Sprite cache" << context << "- hits:" << m_stats.hits << "misses:" << m_stats.misses
+                        << "hit rate:" << (lookups ? 100 * m_stats.hits / lookups : 0) << "%"
+                        << "evictions:" << m_stats.evictions << "entries:" << m_stats.entries
+                        << "resident:" << m_stats.residentBytes / 1024 << "of" << m_budget / 1024 << "KiB,"
+                        << "shared with the renderer:" << m_stats.sharedBytes / 1024 << "KiB";
+}
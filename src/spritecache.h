@@ -0,0 +1,175 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SPRITECACHE_H
+#define SPRITECACHE_H
+
+// Qt
+#include <QHash>
+#include <QMap>
+#include <QPixmap>
+#include <QSize>
+#include <QString>
+
+/**
+ * Rendered sprites of all sizes and themes seen during the session,
+ * shared by all SpriteClients, so that going back to an earlier cell or
+ * window size or theme, or to a screen with an earlier device pixel
+ * ratio, needs no rendering. Sprites are keyed by their size in logical
+ * pixels together with the device pixel ratio they were rendered for.
+ *
+ * Sprites of the renderer's current theme are also kept by
+ * KGameRenderer's own pixmap cache until the theme changes, so
+ * evicting them would free no memory. They are neither counted against
+ * budget() nor evicted. Sprites of other themes are held by this cache
+ * only.
+ *
+ * The cache holds at most budget() bytes of those pixmaps. Over budget, it
+ * evicts sprites of sizes far from those in use first, keeping the
+ * nearest smaller and larger size of each sprite in use as long as
+ * possible, and the least recently used among equals. Sprites in use
+ * are never evicted. When they alone exceed the budget, the cache
+ * stays over budget until some of them are released.
+ *
+ * There is one instance, owned by the scene.
+ */
+class SpriteCache
+{
+public:
+    SpriteCache();
+    ~SpriteCache();
+    /**
+     * @return the instance, or nullptr if there is none
+     */
+    static SpriteCache* instance() { return s_instance; }
+
+    /**
+     * Sets the maximal number of bytes of cached pixmaps, evicting
+     * pixmaps if needed
+     */
+    void setBudget(qint64 bytes);
+    qint64 budget() const { return m_budget; }
+    /**
+     * Sets the theme the renderer currently holds sprites of, see the
+     * class description. Sprites of the previous one count against the
+     * budget from now on
+     */
+    void setRendererTheme(const QString& theme);
+
+    /**
+     * @return sprite of theme with given graphics file, rendered at
+     * size for dpr, or a null pixmap if it's not cached
+     */
+    QPixmap find(const QString& theme, const QString& sprite, const QSize& size, qreal dpr);
+    void insert(const QString& theme, const QString& sprite, const QSize& size, qreal dpr, const QPixmap& pixmap);
+    /**
+     * Marks the sprite at size and dpr as displayed, which protects it
+     * and its neighbour sizes of the same dpr from eviction until release()
+     */
+    void acquire(const QString& theme, const QString& sprite, const QSize& size, qreal dpr);
+    void release(const QString& theme, const QString& sprite, const QSize& size, qreal dpr);
+
+    struct Stats
+    {
+        qint64 hits = 0;
+        qint64 misses = 0;
+        qint64 evictions = 0;
+        /**
+         * Bytes held only by this cache, bounded by the budget
+         */
+        qint64 residentBytes = 0;
+        /**
+         * Bytes of the renderer's theme, also held by the renderer
+         */
+        qint64 sharedBytes = 0;
+        int entries = 0;
+    };
+    Stats stats() const { return m_stats; }
+    /**
+     * Logs stats() through KMINES_LOG
+     */
+    void logStats(const char* context) const;
+private:
+    struct Key
+    {
+        QString theme;
+        QString sprite;
+        QSize size;
+        qreal dpr;
+        bool operator==(const Key& other) const
+        {
+            return size == other.size && dpr == other.dpr && sprite == other.sprite && theme == other.theme;
+        }
+    };
+    friend size_t qHash(const Key& key, size_t seed);
+    /**
+     * All sizes of a sprite of a theme for a dpr
+     */
+    struct GroupKey
+    {
+        QString theme;
+        QString sprite;
+        qreal dpr;
+        bool operator==(const GroupKey& other) const
+        {
+            return dpr == other.dpr && sprite == other.sprite && theme == other.theme;
+        }
+    };
+    friend size_t qHash(const GroupKey& key, size_t seed);
+    static GroupKey groupKey(const Key& key) { return { key.theme, key.sprite, key.dpr }; }
+    static qint64 area(const QSize& size) { return qint64(size.width()) * size.height(); }
+    /**
+     * Number of cached and of in use sizes of a group, by their area
+     */
+    struct Group
+    {
+        QMap<qint64, int> cachedAreas;
+        QMap<qint64, int> usedAreas;
+    };
+    struct Entry
+    {
+        QPixmap pixmap;
+        qint64 bytes;
+        quint64 lastUse;
+    };
+    /**
+     * Evicts pixmaps not in use until resident bytes fit the budget
+     */
+    void evict();
+    /**
+     * Adds (sign 1) or removes (sign -1) bytes of the entry at key
+     * to or from the stats
+     */
+    void account(const Key& key, qint64 bytes, int sign);
+    bool isShared(const Key& key) const { return key.theme == m_rendererTheme; }
+    void removeEntry(QHash<Key, Entry>::iterator it);
+    static void addArea(QMap<qint64, int>& areas, qint64 area);
+    static void removeArea(QMap<qint64, int>& areas, qint64 area);
+    /**
+     * @return true if key's size is the nearest cached size below or
+     * above a size of the same sprite and dpr in use
+     */
+    bool isNextToUsedSize(const Key& key) const;
+
+    static SpriteCache* s_instance;
+    QHash<Key, Entry> m_entries;
+    /**
+     * Number of acquire() minus release() calls per key, if nonzero
+     */
+    QHash<Key, int> m_useCounts;
+    QHash<GroupKey, Group> m_groups;
+    /**
+     * Bytes of cached pixmaps neither in use nor shared, the most
+     * evict() can free
+     */
+    qint64 m_evictableBytes = 0;
+    QString m_rendererTheme;
+    quint64 m_useClock = 0;
+    qint64 m_budget = 32 * 1024 * 1024;
+    Stats m_stats;
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "spriteclient.h"
+
+// own
+#include "renderstats.h"
+#include "spriteatlas.h"
+#include "spritecache.h"
+#include "themeswitch.h"
+// KDEGames
+#include <KGameRenderer>
+#include <KGameTheme>
+#include <KGameThemeProvider>
+
+SpriteClient::SpriteClient(KGameRenderer* renderer, const QString& spriteKey, const std::function<void()>& onChanged)
+    : KGameRendererClient(renderer, spriteKey), m_onChanged(onChanged)
+{
+    m_themeConnection = QObject::connect(renderer, &KGameRenderer::themeChanged, renderer, [this] {
+        onThemeChanged();
+    });
+}
+
+SpriteClient::~SpriteClient()
+{
+    QObject::disconnect(m_themeConnection);
+    if(m_held && ThemeSwitch::instance())
+        ThemeSwitch::instance()->remove(this);
+    release();
+}
+
+void SpriteClient::setRenderSize(const QSize& size, qreal dpr)
+{
+    if(size == m_size && dpr == m_dpr)
+        return;
+    m_size = size;
+    m_dpr = dpr;
+    request();
+}
+
+QString SpriteClient::currentTheme() const
+{
+    return renderer()->themeProvider()->currentTheme()->graphicsPath();
+}
+
+QSize SpriteClient::deviceSize() const
+{
+    return (QSizeF(m_size) * m_dpr).toSize();
+}
+
+void SpriteClient::use(const QString& theme)
+{
+    release();
+    m_usedTheme = theme;
+    m_usedSize = m_size;
+    m_usedDpr = m_dpr;
+    SpriteCache* cache = SpriteCache::instance();
+    if(cache && !m_usedSize.isEmpty())
+        cache->acquire(m_usedTheme, spriteKey(), m_usedSize, m_usedDpr);
+}
+
+void SpriteClient::release()
+{
+    SpriteCache* cache = SpriteCache::instance();
+    if(cache && !m_usedSize.isEmpty())
+        cache->release(m_usedTheme, spriteKey(), m_usedSize, m_usedDpr);
+    m_usedSize = QSize();
+}
+
+void SpriteClient::request()
+{
+    m_ready = false;
+    use(currentTheme());
+    if(requestCached())
+        return;
+
+    if(!m_size.isEmpty())
+    {
+        const SpriteAtlas* atlas = SpriteAtlas::forTheme(m_usedTheme);
+        const QPixmap nearest = atlas ? atlas->nearestPixmap(spriteKey(), deviceSize()) : QPixmap();
+        // scaled stand-in until the renderer delivers
+        if(!nearest.isNull())
+        {
+            QPixmap standIn = nearest.scaled(deviceSize(), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+            standIn.setDevicePixelRatio(m_dpr);
+            setPixmap(standIn, false);
+        }
+        KMinesRenderStats::spriteRenders++;
+    }
+    // may deliver the pixmap right away
+    KGameRendererClient::setRenderSize(deviceSize());
+}
+
+bool SpriteClient::requestCached()
+{
+    QPixmap pixmap;
+    if(!m_size.isEmpty())
+    {
+        // the atlas is in device pixels: on a screen with a device pixel
+        // ratio of 2, the 48 pixel sprites serve 24 pixel cells
+        const SpriteAtlas* atlas = SpriteAtlas::forTheme(m_usedTheme);
+        if(atlas)
+        {
+            pixmap = atlas->pixmap(spriteKey(), deviceSize());
+            pixmap.setDevicePixelRatio(m_dpr);
+        }
+        if(pixmap.isNull() && SpriteCache::instance())
+            pixmap = SpriteCache::instance()->find(m_usedTheme, spriteKey(), m_size, m_dpr);
+    }
+    m_cached = !pixmap.isNull();
+    if(!m_cached)
+        return false;
+
+    // drops pending requests, their results are ignored anyway
+    KGameRendererClient::setRenderSize(QSize());
+    setPixmap(pixmap, true);
+    return true;
+}
+
+void SpriteClient::onThemeChanged()
+{
+    // sprites served by the renderer get re-rendered by it, the
+    // others have to be looked up again for the new theme
+    holdNewTheme();
+    const bool wasCached = m_cached;
+    use(currentTheme());
+    if(requestCached())
+        return;
+    if(!m_size.isEmpty())
+        KMinesRenderStats::spriteRenders++;
+    if(!wasCached)
+        return;
+    m_ready = false;
+    KGameRendererClient::setRenderSize(deviceSize());
+}
+
+void SpriteClient::receivePixmap(const QPixmap& pixmap)
+{
+    if(m_cached)
+        return;
+    // the renderer may deliver for a new theme before onThemeChanged()
+    if(m_usedTheme != currentTheme())
+        holdNewTheme();
+    // rendered at deviceSize(), painted at m_size
+    QPixmap result = pixmap;
+    result.setDevicePixelRatio(m_dpr);
+    // the renderer's default fetch comes before any size is set
+    if(!result.isNull() && !m_size.isEmpty() && SpriteCache::instance())
+        SpriteCache::instance()->insert(currentTheme(), spriteKey(), m_size, m_dpr, result);
+    setPixmap(result, true);
+}
+
+void SpriteClient::setPixmap(const QPixmap& pixmap, bool ready)
+{
+    if(m_held)
+    {
+        m_heldPixmap = pixmap;
+        m_heldSize = m_size;
+        m_heldDpr = m_dpr;
+        m_heldTheme = currentTheme();
+        m_heldReady = ready;
+        if(ready && ThemeSwitch::instance())
+            ThemeSwitch::instance()->update();
+        return;
+    }
+    m_pixmap = pixmap;
+    m_pixmapSize = m_size;
+    m_pixmapDpr = m_dpr;
+    m_ready = ready;
+    m_onChanged();
+}
+
+void SpriteClient::holdNewTheme()
+{
+    if(m_held || m_size.isEmpty() || !ThemeSwitch::instance())
+        return;
+    m_held = true;
+    ThemeSwitch::instance()->hold(this);
+}
+
+bool SpriteClient::isHeldReady() const
+{
+    // a sprite of an earlier new theme doesn't count
+    return m_heldReady && m_heldSize == m_size && m_heldDpr == m_dpr && m_heldTheme == currentTheme();
+}
+
+void SpriteClient::showHeld()
+{
+    m_held = false;
+    // without a held sprite the old theme stays until the new one arrives
+    if(!m_heldSize.isEmpty())
+    {
+        m_pixmap = m_heldPixmap;
+        m_pixmapSize = m_heldSize;
+        m_pixmapDpr = m_heldDpr;
+        m_ready = isHeldReady();
+    }
+    m_heldPixmap = QPixmap();
+    m_heldSize = QSize();
+    m_heldReady = false;
+    m_onChanged();
+}
@@ -0,0 +1,135 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef SPRITECLIENT_H
+#define SPRITECLIENT_H
+
+// KDEGames
+#include <KGameRendererClient>
+// Qt
+#include <QMetaObject>
+#include <QPixmap>
+// Std
+#include <functional>
+
+/**
+ * A theme sprite rendered by KGameRenderer's worker threads, or taken
+ * from the theme's SpriteAtlas if it was prerendered at the size, or
+ * from the SpriteCache if it was rendered before.
+ *
+ * Unlike KGameRenderer::spritePixmap(), requesting a new size doesn't
+ * block: pixmap() keeps the previous pixmap, or the nearest atlas sprite
+ * scaled, until the rendered one arrives. Each change of pixmap() is
+ * announced through the callback, including the re-rendering for a new
+ * theme. The callback may be called from within setRenderSize().
+ *
+ * Sprites of a new theme are held back until the ThemeSwitch lets all
+ * clients show theirs at once; pixmap() keeps the old theme until then.
+ *
+ * Sizes are in logical pixels. The sprite is rendered at the size times
+ * the device pixel ratio and pixmap() carries that ratio, so it is sharp
+ * on high DPI screens while painting at the logical size.
+ */
+class SpriteClient : public KGameRendererClient
+{
+public:
+    SpriteClient(KGameRenderer* renderer, const QString& spriteKey, const std::function<void()>& onChanged);
+    ~SpriteClient() override;
+    /**
+     * Requests the sprite at given logical size for a screen with given
+     * device pixel ratio. Nothing happens if that is requested already
+     */
+    void setRenderSize(const QSize& size, qreal dpr = 1.0);
+    QSize renderSize() const { return m_size; }
+    qreal devicePixelRatio() const { return m_dpr; }
+    /**
+     * @return true if pixmap() is rendered for the requested size
+     */
+    bool isReady() const { return m_ready; }
+    /**
+     * @return true if pixmap() has the requested size and device pixel
+     * ratio, possibly as a scaled stand-in
+     */
+    bool hasPixmap() const { return !m_size.isEmpty() && m_pixmapSize == m_size && m_pixmapDpr == m_dpr; }
+    /**
+     * @return the last pixmap delivered, possibly for an earlier size
+     */
+    QPixmap pixmap() const { return m_pixmap; }
+protected:
+    void receivePixmap(const QPixmap& pixmap) override;
+private:
+    friend class ThemeSwitch;
+    /**
+     * Starts holding back sprites of the new theme, unless already
+     */
+    void holdNewTheme();
+    /**
+     * @return true if the held sprite of the new theme is rendered for
+     * the requested size
+     */
+    bool isHeldReady() const;
+    /**
+     * Shows the held sprite, from then new sprites are shown right away
+     */
+    void showHeld();
+    /**
+     * Requests the sprite for the current size and theme
+     */
+    void request();
+    /**
+     * Takes the sprite from the atlas or the cache if they have it at
+     * the current size
+     * @return true on success
+     */
+    bool requestCached();
+    void onThemeChanged();
+    /**
+     * @return graphics path of the renderer's current theme
+     */
+    QString currentTheme() const;
+    /**
+     * @return the requested size in device pixels
+     */
+    QSize deviceSize() const;
+    /**
+     * Marks the sprite of theme at the requested size and device pixel
+     * ratio as in use in the SpriteCache, instead of the previous one
+     */
+    void use(const QString& theme);
+    void release();
+    void setPixmap(const QPixmap& pixmap, bool ready);
+
+    std::function<void()> m_onChanged;
+    QMetaObject::Connection m_themeConnection;
+    QSize m_size;
+    qreal m_dpr = 1.0;
+    QPixmap m_pixmap;
+    QSize m_pixmapSize;
+    qreal m_pixmapDpr = 1.0;
+    bool m_ready = false;
+    /**
+     * Sprite of a new theme, not shown before showHeld()
+     */
+    bool m_held = false;
+    QPixmap m_heldPixmap;
+    QSize m_heldSize;
+    qreal m_heldDpr = 1.0;
+    QString m_heldTheme;
+    bool m_heldReady = false;
+    /**
+     * True while the sprite is served by the atlas or the cache, the
+     * renderer gets no requests then
+     */
+    bool m_cached = false;
+    /**
+     * Sprite marked as in use in the SpriteCache
+     */
+    QString m_usedTheme;
+    QSize m_usedSize;
+    qreal m_usedDpr = 1.0;
+};
+
+#endif
@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "startupprofile.h"
+
+// own
+#include "kmines_debug.h"
+// Qt
+#include <QElapsedTimer>
+#include <QList>
+
+namespace
+{
+struct Mark
+{
+    const char* milestone;
+    qint64 time;
+};
+
+QElapsedTimer s_timer;
+QList<Mark> s_marks;
+bool s_enabled = false;
+
+void logMark(int i)
+{
+    const qint64 sincePrevious = s_marks[i].time - (i > 0 ? s_marks[i-1].time : 0);
+    if(s_enabled)
+        qCInfo(KMINES_LOG) << "Startup:" << s_marks[i].milestone << "at" << s_marks[i].time << "ms, +" << sincePrevious << "ms";
+    else
+        qCDebug(KMINES_LOG) << "Startup:" << s_marks[i].milestone << "at" << s_marks[i].time << "ms, +" << sincePrevious << "ms";
+}
+}
+
+namespace StartupProfile
+{
+void start()
+{
+    s_timer.start();
+    s_enabled = qEnvironmentVariableIntValue("KMINES_STARTUP_PROFILE") != 0;
+}
+
+void setEnabled(bool enabled)
+{
+    if(enabled && !s_enabled)
+    {
+        s_enabled = true;
+        for(int i=0; i<s_marks.size(); ++i)
+            logMark(i);
+    }
+    s_enabled = enabled;
+}
+
+bool isEnabled()
+{
+    return s_enabled;
+}
+
+void mark(const char* milestone)
+{
+    s_marks.append({ milestone, s_timer.elapsed() });
+    logMark(s_marks.size() - 1);
+}
+
+qint64 elapsed()
+{
+    return s_timer.elapsed();
+}
+}
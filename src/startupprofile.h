@@ -0,0 +1,43 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+// Qt
+#include <QtGlobal>
+
+/**
+ * Milestones of the application startup, with their times.
+ *
+ * Marks are always recorded. They are logged through KMINES_LOG as info
+ * if profiling is enabled, by setting KMINES_STARTUP_PROFILE=1 or with
+ * the --startup-profile option, and as debug messages otherwise.
+ */
+namespace StartupProfile
+{
+/**
+ * Starts the clock, to be called first thing in main()
+ */
+void start();
+/**
+ * Enables logging of marks as info. Marks recorded so far are logged
+ * right away
+ */
+void setEnabled(bool enabled);
+bool isEnabled();
+/**
+ * Records a milestone, with the time since start() and since the
+ * previous one
+ */
+void mark(const char* milestone);
+/**
+ * @return ms since start()
+ */
+qint64 elapsed();
+}
+
+#endif
@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "themeswitch.h"
+
+// own
+#include "kmines_debug.h"
+#include "renderstats.h"
+#include "spritecache.h"
+#include "spriteclient.h"
+
+ThemeSwitch* ThemeSwitch::s_instance = nullptr;
+
+ThemeSwitch::ThemeSwitch()
+{
+    s_instance = this;
+    m_settleTimer.setSingleShot(true);
+    m_settleTimer.setInterval(0);
+    QObject::connect(&m_settleTimer, &QTimer::timeout, &m_settleTimer, [this] {
+        m_settled = true;
+        update();
+    });
+    m_deadlineTimer.setSingleShot(true);
+    m_deadlineTimer.setInterval(MaxHoldTime);
+    QObject::connect(&m_deadlineTimer, &QTimer::timeout, &m_deadlineTimer, [this] {
+        swap(true);
+    });
+}
+
+ThemeSwitch::~ThemeSwitch()
+{
+    s_instance = nullptr;
+}
+
+void ThemeSwitch::hold(SpriteClient* client)
+{
+    if(m_held.isEmpty() && !m_settleTimer.isActive())
+    {
+        m_elapsed.start();
+        m_rendersAtStart = KMinesRenderStats::spriteRenders;
+        m_deadlineTimer.start();
+    }
+    // another theme change before the swap restarts the settling, the
+    // clients are held for the latest theme then
+    m_settled = false;
+    m_settleTimer.start();
+    if(!m_held.contains(client))
+        m_held.append(client);
+}
+
+void ThemeSwitch::update()
+{
+    if(!m_settled)
+        return;
+    for (const SpriteClient* client : std::as_const(m_held)) {
+        if(!client->isHeldReady())
+            return;
+    }
+    swap(false);
+}
+
+void ThemeSwitch::remove(SpriteClient* client)
+{
+    m_held.removeAll(client);
+    update();
+}
+
+void ThemeSwitch::swap(bool timedOut)
+{
+    m_settleTimer.stop();
+    m_deadlineTimer.stop();
+    m_settled = false;
+    const QList<SpriteClient*> held = m_held;
+    m_held.clear();
+    // the clients' callbacks only schedule repaints, all of which end
+    // up in the next frame
+    for (SpriteClient* client : held) {
+        client->showHeld();
+    }
+
+    if(held.isEmpty())
+        return;
+    qCDebug(KMINES_LOG) << "Theme switch took" << m_elapsed.elapsed() << "ms,"
+                        << held.size() << "sprites swapped,"
+                        << KMinesRenderStats::spriteRenders - m_rendersAtStart << "sprite renders"
+                        << (timedOut ? "(timed out, some sprites still rendering)" : "");
+    if(SpriteCache::instance())
+        SpriteCache::instance()->logStats("after theme change");
+}
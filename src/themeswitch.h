@@ -0,0 +1,86 @@
+/*
+    SPDX-FileCopyrightText: 2026 KMines Developers
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#ifndef THEMESWITCH_H
+#define THEMESWITCH_H
+
+// Qt
+#include <QElapsedTimer>
+#include <QList>
+#include <QTimer>
+
+class SpriteClient;
+
+/**
+ * Swaps in a new theme in one go. When the theme changes, each
+ * SpriteClient keeps showing its sprite of the old theme and holds
+ * back the new one while it is rendered. Once all clients have the
+ * new sprites at their current size, they all show them at once, so
+ * the switch is painted in a single frame, without a mix of themes
+ * or placeholders in between.
+ *
+ * A client whose sprite takes longer than MaxHoldTime doesn't hold up
+ * the others any further. The time from the theme change to the swap
+ * is logged through KMINES_LOG.
+ *
+ * There is one instance, owned by the scene.
+ */
+class ThemeSwitch
+{
+public:
+    ThemeSwitch();
+    ~ThemeSwitch();
+    /**
+     * @return the instance, or nullptr if there is none
+     */
+    static ThemeSwitch* instance() { return s_instance; }
+    /**
+     * Time in ms after which the new theme is shown even if some of its
+     * sprites are not rendered yet
+     */
+    static const int MaxHoldTime = 2000;
+
+    /**
+     * @return true while sprites of a new theme are held back
+     */
+    bool isPending() const { return !m_held.isEmpty(); }
+    /**
+     * Called by a client on a theme change, before it requests the
+     * sprite of the new theme
+     */
+    void hold(SpriteClient* client);
+    /**
+     * Called by a held client when its sprite became ready. Swaps if
+     * all held clients are ready
+     */
+    void update();
+    /**
+     * Called by a held client when it is destroyed
+     */
+    void remove(SpriteClient* client);
+private:
+    /**
+     * Shows the held sprites of all clients
+     */
+    void swap(bool timedOut);
+
+    static ThemeSwitch* s_instance;
+    QList<SpriteClient*> m_held;
+    /**
+     * Fires once all clients got the theme change, which they get one
+     * after another. No swap before
+     */
+    QTimer m_settleTimer;
+    bool m_settled = false;
+    QTimer m_deadlineTimer;
+    QElapsedTimer m_elapsed;
+    /**
+     * KMinesRenderStats::spriteRenders when the theme changed
+     */
+    int m_rendersAtStart = 0;
+};
+
+#endif